@@ -0,0 +1,61 @@
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+#include "LinkCalibration.h"
+
+/// @brief Rounds milliseconds up to the whole milliseconds used by the timeouts, at least 1 ms.
+static uint32_t toTimeoutMs(double ms) { return static_cast<uint32_t>(std::max(1.0, std::ceil(ms))); }
+
+double lineTimeMs(size_t bytes, uint32_t baudRate, double bitsPerChar)
+{
+	return baudRate ? static_cast<double>(bytes) * bitsPerChar * 1000.0 / baudRate : 0.0;
+}
+
+link_timeouts_t probeLinkTimeouts(uint32_t baudRate, link_calibration_options_t const& options)
+{
+	link_timeouts_t timeouts;
+	timeouts.readIntervalTimeoutMs = toTimeoutMs(lineTimeMs(1, baudRate, options.bitsPerChar) * options.gapChars);
+	timeouts.readTotalTimeoutConstantMs = options.probeTimeoutMs;
+	return timeouts;
+}
+
+link_timeouts_t deriveLinkTimeouts(uint32_t baudRate, double turnaroundMs, link_calibration_options_t const& options)
+{
+	link_timeouts_t timeouts;
+	timeouts.readIntervalTimeoutMs = toTimeoutMs(lineTimeMs(1, baudRate, options.bitsPerChar) * options.gapChars);
+
+	double const frameMs{ lineTimeMs(kdefault_max_prevac_msg_size, baudRate, options.bitsPerChar) };
+	timeouts.readTotalTimeoutConstantMs = toTimeoutMs((frameMs + turnaroundMs + timeouts.readIntervalTimeoutMs) * options.margin);
+	return timeouts;
+}
+
+bool isReplyTo(prevac_msg_t const& reply, prevac_msg_t const& probe)
+{
+	return reply.deviceAddr == probe.deviceAddr && reply.functionCode == probe.functionCode;
+}
+
+void link_calibration_t::print() const
+{
+	std::cout << std::dec << std::fixed << std::setprecision(2);
+	for (auto const& result : results)
+	{
+		std::cout << std::setw(7) << result.baudRate << " bps: ";
+		if (!result.supported)
+		{
+			std::cout << "not supported" << std::endl;
+			continue;
+		}
+		std::cout << "errors " << result.errors << "/" << result.probes
+			<< ", RTT min/avg/max " << result.minRttMs << "/" << result.avgRttMs << "/" << result.maxRttMs << " ms"
+			<< ", turnaround max " << result.maxTurnaroundMs << " ms" << std::endl;
+	}
+
+	if (calibrated)
+		std::cout << "Selected: " << baudRate << " bps, read interval timeout " << timeouts.readIntervalTimeoutMs
+			<< " ms, read total timeout " << timeouts.readTotalTimeoutMultiplierMs << " ms/byte + "
+			<< timeouts.readTotalTimeoutConstantMs << " ms" << std::endl;
+	else
+		std::cout << "No stable baud rate, fallback: " << baudRate << " bps" << std::endl;
+	std::cout << std::defaultfloat;
+}
@@ -0,0 +1,190 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "PrevacSerial.h"
+
+static constexpr uint32_t const kdefault_calibration_probes{ 20 };             ///< Count of request/reply exchanges at every baud rate.
+static constexpr double const kdefault_calibration_max_error_rate{ 0.0 };      ///< Baud rate is stable only if no exchange failed.
+static constexpr uint32_t const kdefault_calibration_probe_timeout_ms{ 500 };  ///< Generous wait of the reply while probing, the real one is derived after.
+static constexpr double const kdefault_calibration_bits_per_char{ 10.5 };      ///< Start bit + 8 data bits + 1.5 stop bits (default of `setConnectionParameters`).
+static constexpr double const kdefault_calibration_gap_chars{ 3.0 };           ///< Read interval timeout in character times: gap that ends a frame.
+static constexpr double const kdefault_calibration_margin{ 1.5 };              ///< Safety factor applied to the derived total read timeout.
+static constexpr uint32_t const kdefault_calibration_fallback_baud_rate{ 57600 }; ///< Baud rate restored if no rate is stable. Fixed rate of the TM13/TM14.
+
+/**
+ * @struct link_calibration_options_t
+ * @brief Options of the link calibration.
+ */
+struct link_calibration_options_t {
+	std::vector<uint32_t> baudRates{ 9600, 19200, 38400, 57600, 115200, 230400 }; ///< Baud rates to probe.
+	uint32_t probesPerRate{ kdefault_calibration_probes };                        ///< Count of request/reply exchanges at every baud rate.
+	double maxErrorRate{ kdefault_calibration_max_error_rate };                   ///< Max share of failed exchanges for the rate to be stable.
+	uint32_t probeTimeoutMs{ kdefault_calibration_probe_timeout_ms };             ///< Wait of the reply while probing.
+	double bitsPerChar{ kdefault_calibration_bits_per_char };                     ///< Bits on the line per byte, depends on parity and stop bits.
+	double gapChars{ kdefault_calibration_gap_chars };                            ///< Read interval timeout in character times.
+	double margin{ kdefault_calibration_margin };                                 ///< Safety factor of the derived total read timeout.
+	uint32_t fallbackBaudRate{ kdefault_calibration_fallback_baud_rate };         ///< Baud rate restored if no rate is stable.
+};
+
+/**
+ * @struct baud_probe_result_t
+ * @brief Measurements of the link at one baud rate.
+ */
+struct baud_probe_result_t {
+	uint32_t baudRate{};        ///< Probed baud rate.
+	bool supported{};           ///< False if the transport refused the baud rate.
+	uint32_t probes{};          ///< Count of request/reply exchanges.
+	uint32_t errors{};          ///< Count of failed exchanges.
+	double minRttMs{};          ///< Minimal round-trip time of the successful exchanges.
+	double avgRttMs{};          ///< Average round-trip time of the successful exchanges.
+	double maxRttMs{};          ///< Maximal round-trip time of the successful exchanges.
+	double maxTurnaroundMs{};   ///< Maximal time the device took to answer: round-trip time without the time on the line.
+
+	/// @brief Returns share of failed exchanges [0; 1].
+	double errorRate() const { return probes ? static_cast<double>(errors) / probes : 1.0; }
+};
+
+/**
+ * @struct link_calibration_t
+ * @brief Result of the link calibration.
+ */
+struct link_calibration_t {
+	std::vector<baud_probe_result_t> results; ///< Measurements at every probed baud rate.
+	bool calibrated{};                        ///< True if a stable baud rate was found and applied.
+	uint32_t baudRate{};                      ///< Selected (or fallback) baud rate.
+	link_timeouts_t timeouts{};               ///< Read timeouts derived for the selected baud rate, or restored ones on fallback.
+
+	/// @brief Prints the measurements and the selected parameters in a readable format.
+	void print() const;
+};
+
+/**
+ * @brief Returns time in milliseconds the specified count of bytes occupies on the line.
+ * @param bytes Count of bytes.
+ * @param baudRate Baud rate in bps.
+ * @param bitsPerChar Bits on the line per byte.
+ */
+double lineTimeMs(size_t bytes, uint32_t baudRate, double bitsPerChar);
+
+/**
+ * @brief Returns read timeouts used while probing: tight interval timeout, so that the round-trip time
+ *        is measured precisely, and a generous total timeout, so that a slow device isn't taken for a broken link.
+ */
+link_timeouts_t probeLinkTimeouts(uint32_t baudRate, link_calibration_options_t const& options);
+
+/**
+ * @brief Derives read timeouts of the link from the frame size and the device turnaround.
+ *
+ * Interval timeout is `gapChars` character times. Total timeout covers the longest frame
+ * (`kdefault_max_prevac_msg_size`) on the line, the measured turnaround and the interval timeout
+ * ending the frame, multiplied by `margin`. The per-byte multiplier isn't used: reads always request
+ * the longest frame, so the frame time is already in the constant.
+ *
+ * @param baudRate Baud rate in bps.
+ * @param turnaroundMs Max time the device takes to answer.
+ * @param options Calibration options.
+ */
+link_timeouts_t deriveLinkTimeouts(uint32_t baudRate, double turnaroundMs, link_calibration_options_t const& options);
+
+/**
+ * @brief Checks that the received frame is a reply to the probe: its device address and function code
+ *        are the ones of the probe. Integrity (CRC) is already checked by `parsePrevacFrame`.
+ * @param reply Received frame.
+ * @param probe Sent probe.
+ */
+bool isReplyTo(prevac_msg_t const& reply, prevac_msg_t const& probe);
+
+/**
+ * @brief Calibrates the link: selects the fastest stable baud rate and derives the read timeouts for it.
+ *
+ * At every baud rate of `options.baudRates` sends `probe` `options.probesPerRate` times and waits for the reply,
+ * measuring round-trip time and share of failed exchanges. The fastest rate with error rate not exceeding
+ * `options.maxErrorRate` is applied together with the timeouts derived by `deriveLinkTimeouts`.
+ * If no rate is stable, `options.fallbackBaudRate` is restored together with the read timeouts
+ * the transport had before probing. An exchange counts as successful only if the reply passes `isReplyTo`.
+ *
+ * @param serial Connected PREVAC serial over a calibratable transport.
+ * @param probe Message the device replies to. It must be harmless, as it is sent many times.
+ * @param options Calibration options.
+ * @return Measurements and selected parameters.
+ */
+template<CalibratableTransport Transport>
+link_calibration_t calibrateLink(BasicPrevacSerial<Transport>& serial, prevac_msg_t const& probe,
+	link_calibration_options_t const& options = {})
+{
+	using clock = std::chrono::steady_clock;
+
+	// Probing overwrites the read timeouts: the previous ones are restored if no rate is stable.
+	link_timeouts_t const previousTimeouts{ serial.transport().linkTimeouts() };
+
+	link_calibration_t calibration;
+	for (uint32_t baudRate : options.baudRates)
+	{
+		baud_probe_result_t result;
+		result.baudRate = baudRate;
+		result.supported = serial.transport().setBaudRate(baudRate) &&
+			serial.transport().setLinkTimeouts(probeLinkTimeouts(baudRate, options));
+		if (!result.supported)
+		{
+			calibration.results.emplace_back(result);
+			continue;
+		}
+
+		double const intervalMs{ static_cast<double>(probeLinkTimeouts(baudRate, options).readIntervalTimeoutMs) };
+		double sumRttMs{};
+		prevac_msg_t reply;
+		for (uint32_t i{}; i < options.probesPerRate; ++i)
+		{
+			++result.probes;
+
+			auto const start{ clock::now() };
+			if (!serial.sendMessage(probe) || !serial.receiveMessage(reply) || !isReplyTo(reply, probe))
+			{
+				++result.errors;
+				continue;
+			}
+			double const rttMs{ std::chrono::duration<double, std::milli>(clock::now() - start).count() };
+
+			// Read ends only after the interval timeout, so it isn't a part of the device turnaround.
+			double const onLineMs{ lineTimeMs(probe.size() + reply.size(), baudRate, options.bitsPerChar) };
+			double const turnaroundMs{ std::max(0.0, rttMs - onLineMs - intervalMs) };
+
+			uint32_t const successes{ result.probes - result.errors };
+			result.minRttMs = successes == 1 ? rttMs : std::min(result.minRttMs, rttMs);
+			result.maxRttMs = std::max(result.maxRttMs, rttMs);
+			result.maxTurnaroundMs = std::max(result.maxTurnaroundMs, turnaroundMs);
+			sumRttMs += rttMs;
+		}
+		if (result.probes != result.errors)
+			result.avgRttMs = sumRttMs / (result.probes - result.errors);
+		calibration.results.emplace_back(result);
+	}
+
+	// The fastest stable rate wins, regardless of the probing order.
+	baud_probe_result_t const* best{};
+	for (auto const& result : calibration.results)
+		if (result.supported && result.probes != result.errors && result.errorRate() <= options.maxErrorRate &&
+			(!best || result.baudRate > best->baudRate))
+			best = &result;
+
+	if (!best)
+	{
+#ifdef LOG_ON
+		std::cerr << "Error: Link calibration didn't find a stable baud rate, restoring " << options.fallbackBaudRate << " bps\n";
+#endif
+		calibration.baudRate = options.fallbackBaudRate;
+		calibration.timeouts = previousTimeouts;
+		serial.transport().setBaudRate(options.fallbackBaudRate);
+		serial.transport().setLinkTimeouts(calibration.timeouts);
+		return calibration;
+	}
+
+	calibration.baudRate = best->baudRate;
+	calibration.timeouts = deriveLinkTimeouts(best->baudRate, best->maxTurnaroundMs, options);
+	calibration.calibrated = serial.transport().setBaudRate(calibration.baudRate) &&
+		serial.transport().setLinkTimeouts(calibration.timeouts);
+	return calibration;
+}
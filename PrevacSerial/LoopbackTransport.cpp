@@ -0,0 +1,55 @@
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#include "LoopbackTransport.h"
+
+bool LoopbackTransport::write(uint8_t const* data, size_t size)
+{
+	if (size > kdefault_max_prevac_msg_size)
+	{
+#ifdef LOG_ON
+		std::cerr << "Error: Loopback can't hold " << size << " bytes in one write\n";
+#endif
+		return false;
+	}
+
+	size_t const tail{ m_tail.load(std::memory_order_relaxed) };
+	if (tail - m_head.load(std::memory_order_acquire) == kdefault_loopback_capacity)
+		return false;
+
+	slot_t& slot{ m_slots[tail % kdefault_loopback_capacity] };
+	std::memcpy(slot.bytes, data, size);
+	slot.size = size;
+
+	m_tail.store(tail + 1, std::memory_order_release);
+	return true;
+}
+
+bool LoopbackTransport::read(uint8_t* buffer, size_t bufferSize, size_t& bytesRead)
+{
+	bytesRead = 0;
+
+	size_t const head{ m_head.load(std::memory_order_relaxed) };
+	if (head == m_tail.load(std::memory_order_acquire))
+		return true;
+
+	slot_t const& slot{ m_slots[head % kdefault_loopback_capacity] };
+	bytesRead = std::min(bufferSize, slot.size - m_readOffset);
+	std::memcpy(buffer, slot.bytes + m_readOffset, bytesRead);
+
+	m_readOffset += bytesRead;
+	if (m_readOffset == slot.size)
+	{
+		m_readOffset = 0;
+		m_head.store(head + 1, std::memory_order_release);
+	}
+	return true;
+}
+
+size_t LoopbackTransport::pending() const noexcept
+{
+	// Head first: tail loaded later is never behind it.
+	size_t const head{ m_head.load(std::memory_order_acquire) };
+	return m_tail.load(std::memory_order_acquire) - head;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "PrevacMessageType.h"
+
+static constexpr size_t const kdefault_loopback_capacity{ 64 }; ///< Count of frames the in-memory loopback holds before `write` fails.
+
+/**
+ * @brief In-memory transport: bytes written are read back by the same or another thread.
+ *
+ * Lets the whole send/receive stack run without hardware, e.g. in unit tests and profiling runs.
+ * Every `write` is delivered as one `read`, like a frame followed by an inter-character gap on a serial line.
+ * Safe for one writing thread and one reading thread at a time (single producer, single consumer).
+ */
+class LoopbackTransport {
+private:
+	/// @brief One written chunk of bytes.
+	struct slot_t {
+		size_t size;                                  ///< Count of bytes in the slot.
+		uint8_t bytes[kdefault_max_prevac_msg_size];  ///< Written bytes.
+	};
+
+	slot_t m_slots[kdefault_loopback_capacity]{}; ///< Ring of written chunks.
+	alignas(64) std::atomic<size_t> m_head{};     ///< Index of the next slot to read. Modified only by the reader.
+	alignas(64) std::atomic<size_t> m_tail{};     ///< Index of the next slot to write. Modified only by the writer.
+	size_t m_readOffset{};                        ///< Bytes of the head slot already read by a smaller buffer.
+
+public:
+	LoopbackTransport() = default;
+
+	LoopbackTransport(LoopbackTransport const&) = delete;
+	LoopbackTransport& operator=(LoopbackTransport const&) = delete;
+
+	/**
+	 * @brief Queues data to be read back.
+	 * @param data Pointer to the data to write.
+	 * @param size Number of bytes to write. Must not exceed `kdefault_max_prevac_msg_size`.
+	 * @return True if data was queued, False if the loopback is full or the chunk is too large.
+	 */
+	bool write(uint8_t const* data, size_t size);
+
+	/**
+	 * @brief Reads the oldest queued chunk. If the buffer is smaller than the chunk,
+	 *        the rest of the chunk is returned by the next reads.
+	 * @param buffer Pointer to the buffer to store read data.
+	 * @param bufferSize Size of the buffer, indicating max bytes to read.
+	 * @param bytesRead Reference to store the number of bytes actually read. 0 if nothing is queued.
+	 * @return Always True: empty loopback behaves like a read timeout.
+	 */
+	bool read(uint8_t* buffer, size_t bufferSize, size_t& bytesRead);
+
+	/// @brief Returns count of queued chunks.
+	size_t pending() const noexcept;
+};
@@ -0,0 +1,202 @@
+#include <algorithm>
+#include <exception>
+#include <iostream>
+
+#include "PrevacDispatcher.h"
+
+PrevacDispatcher::PrevacDispatcher(size_t workers)
+{
+	workers = std::max<size_t>(workers, 1);
+	m_workers.reserve(workers);
+	for (size_t i{}; i < workers; ++i)
+		m_workers.emplace_back([this](std::stop_token stopToken) { work_(stopToken); });
+}
+
+PrevacDispatcher::~PrevacDispatcher()
+{
+	// Workers must be joined before the subscribers they may be handling are destroyed.
+	for (auto& worker : m_workers)
+		worker.request_stop();
+	m_workers.clear();
+}
+
+bool PrevacDispatcher::enqueue_(subscriber_t& subscriber, prevac_msg_t const& msg, std::chrono::steady_clock::time_point now)
+{
+	size_t const capacity{ subscriber.ring.size() };
+	auto& metrics{ subscriber.metrics };
+	++metrics.delivered;
+
+	if (subscriber.options.overflowPolicy == overflow_policy_t::CoalesceLatest)
+	{
+		for (size_t i{}; i < subscriber.size; ++i)
+		{
+			entry_t& entry{ subscriber.ring[(subscriber.head + i) % capacity] };
+			if (entry.msg.deviceAddr == msg.deviceAddr && entry.msg.functionCode == msg.functionCode)
+			{
+				// Keeping the place in the queue and the moment of queueing: lag shows how stale the value got.
+				entry.msg = msg;
+				++metrics.coalesced;
+				return false;
+			}
+		}
+	}
+
+	if (subscriber.size == capacity)
+	{
+		if (subscriber.options.overflowPolicy == overflow_policy_t::DropNewest)
+		{
+			++metrics.dropped;
+			return false;
+		}
+
+		subscriber.head = (subscriber.head + 1) % capacity;
+		--subscriber.size;
+		++metrics.dropped;
+	}
+
+	entry_t& entry{ subscriber.ring[(subscriber.head + subscriber.size) % capacity] };
+	entry.msg = msg;
+	entry.queuedAt = now;
+	++subscriber.size;
+
+	metrics.queueDepth = subscriber.size;
+	metrics.maxQueueDepth = std::max(metrics.maxQueueDepth, subscriber.size);
+
+	if (subscriber.scheduled)
+		return false;
+	subscriber.scheduled = true;
+	return true;
+}
+
+void PrevacDispatcher::schedule_(subscriber_t& subscriber)
+{
+	{
+		std::lock_guard lock(m_readyMutex);
+		m_ready[(m_readyHead + m_readySize) % m_ready.size()] = &subscriber;
+		++m_readySize;
+	}
+	m_readyCv.notify_one();
+}
+
+void PrevacDispatcher::work_(std::stop_token stopToken)
+{
+	prevac_msg_t msg;
+	while (true)
+	{
+		subscriber_t* subscriber{};
+		{
+			std::unique_lock lock(m_readyMutex);
+			if (!m_readyCv.wait(lock, stopToken, [this] { return m_readySize != 0; }))
+				return;
+
+			subscriber = m_ready[m_readyHead];
+			m_readyHead = (m_readyHead + 1) % m_ready.size();
+			--m_readySize;
+		}
+
+		// Taking one frame at a time: the handler runs without locks, so `dispatch` never waits for it.
+		{
+			std::lock_guard lock(subscriber->mutex);
+			entry_t const& entry{ subscriber->ring[subscriber->head] };
+			msg = entry.msg;
+
+			auto& metrics{ subscriber->metrics };
+			metrics.lastLagUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - entry.queuedAt).count();
+			metrics.maxLagUs = std::max(metrics.maxLagUs, metrics.lastLagUs);
+
+			subscriber->head = (subscriber->head + 1) % subscriber->ring.size();
+			--subscriber->size;
+			metrics.queueDepth = subscriber->size;
+		}
+
+		bool failed{};
+		try
+		{
+			subscriber->handler(msg);
+		}
+		catch (std::exception const& e)
+		{
+#ifdef LOG_ON
+			std::cerr << "Error: Subscriber handler failed: " << e.what() << '\n';
+#endif
+			failed = true;
+		}
+		catch (...)
+		{
+#ifdef LOG_ON
+			std::cerr << "Error: Subscriber handler failed with an unknown exception\n";
+#endif
+			failed = true;
+		}
+
+		// Still scheduled: no other worker can take this subscriber, so its frames are handled in order.
+		bool hasMore{};
+		{
+			std::lock_guard lock(subscriber->mutex);
+			++subscriber->metrics.processed;
+			if (failed)
+				++subscriber->metrics.failed;
+
+			hasMore = subscriber->size != 0;
+			subscriber->scheduled = hasMore;
+		}
+
+		// Back to the end of the ready queue, so one busy subscriber doesn't starve the others.
+		if (hasMore)
+			schedule_(*subscriber);
+	}
+}
+
+PrevacDispatcher::subscription_id_t PrevacDispatcher::subscribe(subscription_filter_t const& filter, handler_t handler, subscriber_options_t const& options)
+{
+	auto subscriber{ std::make_unique<subscriber_t>() };
+	subscriber->filter = filter;
+	subscriber->handler = std::move(handler);
+	subscriber->options = options;
+	subscriber->ring.resize(std::max<size_t>(options.queueCapacity, 1));
+
+	std::unique_lock lock(m_subscribersMutex);
+	m_subscribers.emplace_back(std::move(subscriber));
+
+	// Growing the ready ring by one slot, keeping the order of the ready subscribers. `dispatch` is blocked
+	// by the lock above, so the new subscriber can't be scheduled before its slot exists.
+	{
+		std::lock_guard readyLock(m_readyMutex);
+		std::vector<subscriber_t*> ready(m_subscribers.size());
+		for (size_t i{}; i < m_readySize; ++i)
+			ready[i] = m_ready[(m_readyHead + i) % m_ready.size()];
+		m_ready.swap(ready);
+		m_readyHead = 0;
+	}
+	return m_subscribers.size() - 1;
+}
+
+void PrevacDispatcher::dispatch(prevac_msg_t const& msg)
+{
+	auto const now{ std::chrono::steady_clock::now() };
+
+	std::shared_lock lock(m_subscribersMutex);
+	for (auto& subscriber : m_subscribers)
+	{
+		if (!subscriber->filter.matches(msg))
+			continue;
+
+		bool mustSchedule{};
+		{
+			std::lock_guard subscriberLock(subscriber->mutex);
+			mustSchedule = enqueue_(*subscriber, msg, now);
+		}
+		if (mustSchedule)
+			schedule_(*subscriber);
+	}
+}
+
+subscriber_metrics_t PrevacDispatcher::metrics(subscription_id_t id) const
+{
+	std::shared_lock lock(m_subscribersMutex);
+	if (id >= m_subscribers.size())
+		return {};
+
+	std::lock_guard subscriberLock(m_subscribers[id]->mutex);
+	return m_subscribers[id]->metrics;
+}
@@ -0,0 +1,216 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+#include "PrevacSerial.h"
+
+static constexpr size_t const kdefault_dispatcher_workers{ 2 };          ///< Default count of worker threads running the handlers.
+static constexpr size_t const kdefault_subscriber_queue_capacity{ 64 };  ///< Default count of frames queued per subscriber.
+
+/// @brief What happens with a frame that arrives when the queue of the subscriber is full.
+enum class overflow_policy_t : uint8_t {
+	DropNewest,    ///< The arrived frame is dropped, queued frames are kept.
+	DropOldest,    ///< The oldest queued frame is dropped to make room for the arrived one.
+	CoalesceLatest ///< A queued frame with the same device address and function code is replaced by the arrived one,
+	               ///< even if the queue isn't full: the subscriber only needs the latest value. Otherwise as DropOldest.
+};
+
+/**
+ * @struct subscription_filter_t
+ * @brief Selects frames delivered to the subscriber. Unset field matches any value.
+ */
+struct subscription_filter_t {
+	std::optional<uint8_t> deviceAddr;   ///< Device address of the frame.
+	std::optional<uint8_t> functionCode; ///< Function code of the frame.
+
+	/// @brief Checks if the frame passes the filter.
+	bool matches(prevac_msg_t const& msg) const
+	{
+		return (!deviceAddr || *deviceAddr == msg.deviceAddr) && (!functionCode || *functionCode == msg.functionCode);
+	}
+};
+
+/**
+ * @struct subscriber_options_t
+ * @brief Queueing options of the subscriber.
+ */
+struct subscriber_options_t {
+	size_t queueCapacity{ kdefault_subscriber_queue_capacity };    ///< Max count of frames waiting for the handler.
+	overflow_policy_t overflowPolicy{ overflow_policy_t::DropOldest }; ///< What to do with frames that don't fit.
+};
+
+/**
+ * @struct subscriber_metrics_t
+ * @brief Counters of the subscriber. Lag is the time between handing off the frame by `dispatch`
+ *        and starting the handler with it.
+ */
+struct subscriber_metrics_t {
+	uint64_t delivered{};   ///< Frames that passed the filter.
+	uint64_t processed{};   ///< Frames the handler has been run with.
+	uint64_t dropped{};     ///< Frames dropped because of the full queue.
+	uint64_t coalesced{};   ///< Queued frames replaced by newer ones.
+	uint64_t failed{};      ///< Handler runs that threw anything.
+	size_t queueDepth{};    ///< Frames waiting for the handler now.
+	size_t maxQueueDepth{}; ///< Max count of frames that were waiting for the handler.
+	double lastLagUs{};     ///< Lag of the last processed frame in microseconds.
+	double maxLagUs{};      ///< Max lag in microseconds.
+};
+
+/**
+ * @struct receive_stats_t
+ * @brief Counters of the receive loop. Updated by the receiving thread, may be read by any thread.
+ */
+struct receive_stats_t {
+	std::atomic<uint64_t> frames{};       ///< Frames decoded and dispatched.
+	std::atomic<uint64_t> timeouts{};     ///< Reads that ended without any byte.
+	std::atomic<uint64_t> decodeErrors{}; ///< Reads whose bytes didn't form a valid frame.
+};
+
+/**
+ * @brief Fans decoded frames out to subscribers on a worker pool.
+ *
+ * The receiving thread only calls `dispatch`, which copies the frame into the bounded queues of the matching
+ * subscribers and returns: slow handlers never stall reception. Frames of one subscriber are handled
+ * one by one in the order of arrival; different subscribers are handled in parallel by the workers.
+ * Handlers that reply over `BasicPrevacSerial` may thus run concurrently and must serialize their
+ * `sendMessage` calls, as it has a single tx buffer.
+ */
+class PrevacDispatcher {
+public:
+	using handler_t = std::function<void(prevac_msg_t const&)>; ///< Handler of the frames delivered to the subscriber.
+	using subscription_id_t = size_t;                           ///< Identifier of the subscriber.
+
+private:
+	/// @brief Queued frame.
+	struct entry_t {
+		prevac_msg_t msg;                                ///< Copy of the frame.
+		std::chrono::steady_clock::time_point queuedAt;  ///< Moment of handing off the frame.
+	};
+
+	/// @brief Subscriber with its bounded queue.
+	struct subscriber_t {
+		subscription_filter_t filter;  ///< Selects delivered frames.
+		handler_t handler;             ///< Handler of the frames.
+		subscriber_options_t options;  ///< Queueing options.
+
+		mutable std::mutex mutex;      ///< Guards all the fields below.
+		std::vector<entry_t> ring;     ///< Queue storage, allocated once.
+		size_t head{};                 ///< Index of the oldest queued frame.
+		size_t size{};                 ///< Count of the queued frames.
+		bool scheduled{};              ///< True while the subscriber is in the ready queue or being handled by a worker.
+		subscriber_metrics_t metrics;  ///< Counters.
+	};
+
+	mutable std::shared_mutex m_subscribersMutex;              ///< Guards the list of subscribers.
+	std::vector<std::unique_ptr<subscriber_t>> m_subscribers;  ///< Subscribers, index is the subscription id.
+
+	std::mutex m_readyMutex;                  ///< Guards the ready queue.
+	std::condition_variable_any m_readyCv;    ///< Wakes up workers when a subscriber becomes ready.
+	std::vector<subscriber_t*> m_ready;       ///< Ring of subscribers having queued frames and no worker yet. A subscriber is in it at most once,
+	                                          ///< so one slot per subscriber, allocated by `subscribe`: scheduling never allocates.
+	size_t m_readyHead{};                     ///< Index of the first ready subscriber.
+	size_t m_readySize{};                     ///< Count of the ready subscribers.
+	std::vector<std::jthread> m_workers;      ///< Worker pool.
+
+	/**
+	 * @brief Queues the frame to the subscriber according to its overflow policy.
+	 * @return True if the subscriber must be put into the ready queue.
+	 */
+	bool enqueue_(subscriber_t& subscriber, prevac_msg_t const& msg, std::chrono::steady_clock::time_point now);
+
+	/// @brief Puts the subscriber into the ready queue and wakes up a worker.
+	void schedule_(subscriber_t& subscriber);
+
+	/// @brief Worker loop: takes ready subscribers and runs their handlers frame by frame.
+	void work_(std::stop_token stopToken);
+
+public:
+	/**
+	 * @brief Starts the worker pool.
+	 * @param workers Count of worker threads, at least 1.
+	 */
+	explicit PrevacDispatcher(size_t workers = kdefault_dispatcher_workers);
+
+	/// @brief Stops the worker pool. Frames still queued are discarded.
+	~PrevacDispatcher();
+
+	PrevacDispatcher(PrevacDispatcher const&) = delete;
+	PrevacDispatcher& operator=(PrevacDispatcher const&) = delete;
+
+	/**
+	 * @brief Adds the subscriber. May be called while frames are being dispatched.
+	 * @param filter Selects delivered frames.
+	 * @param handler Handler of the frames, run on a worker thread.
+	 * @param options Queueing options.
+	 * @return Identifier of the subscriber to query its metrics.
+	 */
+	subscription_id_t subscribe(subscription_filter_t const& filter, handler_t handler, subscriber_options_t const& options = {});
+
+	/**
+	 * @brief Hands the frame off to the matching subscribers. Never waits for handlers.
+	 * @param msg Decoded frame.
+	 */
+	void dispatch(prevac_msg_t const& msg);
+
+	/**
+	 * @brief Returns snapshot of the subscriber counters.
+	 * @param id Identifier returned by `subscribe`.
+	 */
+	subscriber_metrics_t metrics(subscription_id_t id) const;
+};
+
+/**
+ * @brief Receive loop: decodes frames from the serial and hands them off to the dispatcher until stop is requested.
+ *        Intended to be the body of the I/O thread, e.g. `std::jthread` with the real-time profile applied.
+ *
+ * Timeouts and undecodable frames are counted and the loop goes on: the next read starts at the next frame.
+ * A transport error ends the loop, as retrying a failed (e.g. disconnected) port would only spin;
+ * reconnecting is up to the caller.
+ *
+ * @param serial PREVAC serial over any transport.
+ * @param dispatcher Dispatcher of the decoded frames.
+ * @param stopToken Stops the loop after the current read.
+ * @param stats Optional counters of the loop.
+ * @return True if the loop was stopped, False if it ended on a transport error.
+ */
+template<PrevacTransport Transport>
+bool receiveAndDispatch(BasicPrevacSerial<Transport>& serial, PrevacDispatcher& dispatcher, std::stop_token stopToken,
+	receive_stats_t* stats = nullptr)
+{
+	prevac_msg_t msg;
+	while (!stopToken.stop_requested())
+	{
+		switch (serial.tryReceiveMessage(msg))
+		{
+		case receive_status_t::Ok:
+			dispatcher.dispatch(msg);
+			if (stats)
+				stats->frames.fetch_add(1, std::memory_order_relaxed);
+			break;
+		case receive_status_t::Timeout:
+			if (stats)
+				stats->timeouts.fetch_add(1, std::memory_order_relaxed);
+			// Transports without a wait (e.g. the empty loopback) return at once, so the core is yielded.
+			std::this_thread::yield();
+			break;
+		case receive_status_t::DecodeError:
+			if (stats)
+				stats->decodeErrors.fetch_add(1, std::memory_order_relaxed);
+			break;
+		case receive_status_t::TransportError:
+			return false;
+		}
+	}
+	return true;
+}
@@ -1,11 +1,14 @@
 #include <algorithm>
+#include <cstring>
 #include <iomanip>
 #include <iostream>
 #include <iterator>
 #include <sstream>
+#include <stdexcept>
 #include <vector>
 
 #include "PrevacMessageType.h"
+#include "Utilities.h"
 
 static void checkDataLen(uint16_t& dataLen)
 {
@@ -70,7 +73,7 @@ void prevac_msg_t::calculateCRC()
 	uint16_t sum{};
 
 	sum += dataLen + deviceAddr + deviceGroup + logicGroup + driverAddr + functionCode;
-	for (uint8_t i{}; i < dataLen; ++i)
+	for (uint16_t i{}; i < dataLen; ++i)
 		if (data[i] != 0x00)
 			sum += data[i];
 
@@ -126,7 +129,7 @@ void prevac_msg_t::print() const
 		<< std::setw(2) << static_cast<int>(logicGroup) << " "
 		<< std::setw(2) << static_cast<int>(driverAddr) << " "
 		<< std::setw(2) << static_cast<int>(functionCode) << " ";
-	for (uint8_t i{}; i < dataLen; ++i)
+	for (uint16_t i{}; i < dataLen; ++i)
 		std::cout << std::setw(2) << static_cast<int>(data[i]) << " ";
 	std::cout << std::setw(2) << static_cast<int>(crc) << std::endl;
 }
@@ -141,7 +144,7 @@ void prevac_msg_t::printDetailed() const
 		<< "Driver Address: " << std::setw(2) << static_cast<int>(driverAddr) << std::endl
 		<< "Function Code: " << std::setw(2) << static_cast<int>(functionCode) << std::endl
 		<< "Data: ";
-	for (uint8_t i{}; i < dataLen; ++i)
+	for (uint16_t i{}; i < dataLen; ++i)
 		std::cout << std::hex << std::setw(2) << static_cast<int>(data[i]) << " ";
 	std::cout << std::endl << "CRC: " << std::setw(2) << static_cast<int>(crc) << std::endl;
 }
@@ -149,7 +152,7 @@ void prevac_msg_t::printDetailed() const
 void prevac_msg_t::printDataAsString() const
 {
 	std::cout << "Data(str): ";
-	for (uint8_t i{}; i < dataLen; ++i)
+	for (uint16_t i{}; i < dataLen; ++i)
 		std::cout << static_cast<char>(data[i]);
 	std::endl(std::cout);
 }
@@ -11,6 +11,7 @@ static constexpr uint8_t const kdefault_logic_group{ 0xc8 };	///< Default value
 static constexpr uint8_t const kdefault_driver_addr{ 0x01 };	///< Default value for the driver address of the Prevac message.
 
 /* Other default values. */
+static constexpr uint8_t const kdefault_max_line_data_len{ 0xff };                ///< Max data length that fits into the one-byte data length field on the line.
 static constexpr uint8_t const kdefault_null_value{ 0x00 };                       ///< Default null value.
 static constexpr uint8_t const kdefault_message_parts_count{ 0x09 };		      ///< Prevac message parts count including the data.
 static constexpr uint8_t const kdefault_message_parts_count_without_data{ 0x08 }; ///< Prevac message parts count excluding the data.
@@ -42,6 +43,9 @@ struct prevac_msg_t {
 	/// @brief Parametrized with another instance of `prevac_msg_t` ctor.
 	prevac_msg_t(prevac_msg_t const& msg_);
 
+	/// @brief Copy assignment, same member-wise copy as the implicit one. Declared, as the implicit one is deprecated next to the user-provided copy ctor.
+	prevac_msg_t& operator=(prevac_msg_t const& msg_) = default;
+
 	/**
 	 * @brief Calculates CRC (Cyclic Redundancy Code)
 	 *        From the user manual: CRC is simple modulo 256 calculate without protocol header byte.
@@ -55,11 +59,15 @@ struct prevac_msg_t {
 	void setMessage(std::string_view data_);
 
 	/**
-	 * @brief Calculates the total size of the message, combining fixed and variable parts.
-	 * @return Total size of the message in bytes.
+	 * @brief Calculates the total size of the message on the line, combining fixed and variable parts.
+	 *        Data length occupies one byte on the line, even though the field is wider in memory.
+	 * @return Total size of the message in bytes, 0 if `dataLen` exceeds `kdefault_max_line_data_len`
+	 *         and the message can't be sent.
 	 */
 	constexpr size_t size() const {
-		return sizeof(header) + sizeof(dataLen) + sizeof(deviceAddr) +
+		if (dataLen > kdefault_max_line_data_len)
+			return 0;
+		return sizeof(header) + sizeof(uint8_t) + sizeof(deviceAddr) +
 			sizeof(deviceGroup) + sizeof(logicGroup) + sizeof(driverAddr) +
 			sizeof(functionCode) + dataLen + sizeof(crc);
 	}
@@ -1,25 +1,26 @@
-#include <exception>
 #include <iostream>
 #include <cstring>
 
 #include "PrevacSerial.h"
 #include "Utilities.h"
 
-void PrevacSerial::clearBuffer_(uint8_t* buffer)
-{
-	if (buffer)
-		delete[] buffer;
-	buffer = nullptr;
-}
-
-void PrevacSerial::copyToBuffer_(uint8_t* buffer, size_t buffer_size, size_t& offset, const void* source, size_t size)
+/**
+ * @brief Copies data from source to buffer at the specified offset and updates the offset.
+ * @param buffer Pointer to the destination buffer.
+ * @param buffer_size Size of the buffer.
+ * @param offset Reference to the current offset in the buffer, will be updated after copy.
+ * @param source Pointer to the source data to copy.
+ * @param size Number of bytes to copy.
+ * @return True if the data was copied, False otherwise.
+ */
+static bool copyToBuffer(uint8_t* buffer, size_t buffer_size, size_t& offset, const void* source, size_t size)
 {
 	if (offset + size > buffer_size)
 	{
 #ifdef LOG_ON
 		std::cerr << "Buffer overflow prevented in " << __FUNCSIG__ << '\n';
 #endif
-		return;
+		return false;
 	}
 
 	errno_t err{ memcpy_s(buffer + offset, buffer_size - offset, source, size) };
@@ -28,166 +29,67 @@ void PrevacSerial::copyToBuffer_(uint8_t* buffer, size_t buffer_size, size_t& of
 #ifdef LOG_ON
 		std::cerr << "memcpy_s failed in " << __FUNCSIG__ << '\n';
 #endif
-		return;
+		return false;
 	}
 
 	offset += size;
+	return true;
 }
 
-void PrevacSerial::buildMessage_(uint8_t* buffer, size_t buffer_size, prevac_msg_t const& msg)
-{
-	size_t offset{};
-	copyToBuffer_(buffer, buffer_size, offset, &msg.header, sizeof(msg.header));
-	copyToBuffer_(buffer, buffer_size, offset, &msg.dataLen, sizeof(msg.dataLen));
-	copyToBuffer_(buffer, buffer_size, offset, &msg.deviceAddr, sizeof(msg.deviceAddr));
-	copyToBuffer_(buffer, buffer_size, offset, &msg.deviceGroup, sizeof(msg.deviceGroup));
-	copyToBuffer_(buffer, buffer_size, offset, &msg.logicGroup, sizeof(msg.logicGroup));
-	copyToBuffer_(buffer, buffer_size, offset, &msg.driverAddr, sizeof(msg.driverAddr));
-	copyToBuffer_(buffer, buffer_size, offset, &msg.functionCode, sizeof(msg.functionCode));
-	copyToBuffer_(buffer, buffer_size, offset, msg.data, msg.dataLen);
-	copyToBuffer_(buffer, buffer_size, offset, &msg.crc, sizeof(msg.crc));
-}
-
-PrevacSerial::~PrevacSerial()
-{
-	if (m_hSerial != INVALID_HANDLE_VALUE)
-	{
-		CloseHandle(m_hSerial);
-		m_hSerial = INVALID_HANDLE_VALUE;
-	}
-}
-
-void PrevacSerial::setConnectionParameters(BYTE dataBits, BYTE parity, BYTE stopBits, DWORD flowControl, DWORD baudRate)
-{
-	m_dcbSerialParams.ByteSize = dataBits;       // Data bits.
-	m_dcbSerialParams.Parity = parity;           // None parity.
-	m_dcbSerialParams.StopBits = stopBits;       // Stop bits.
-	m_dcbSerialParams.fDtrControl = flowControl; // None flow control.
-	m_dcbSerialParams.BaudRate = baudRate;       // 57600 baud rate.
-}
-
-void PrevacSerial::setConnectionTimeouts(DWORD readIntervalTimeout, DWORD readTotalTimeoutMultiplier, DWORD readTotalTimeoutConstant, DWORD writeTotalTimeoutMultiplier, DWORD writeTotalTimeoutConstant)
-{
-	m_timeouts.ReadIntervalTimeout = readIntervalTimeout;                 // Maximum time between read chars.
-	m_timeouts.ReadTotalTimeoutMultiplier = readTotalTimeoutMultiplier;   // Multiplier of characters.
-	m_timeouts.ReadTotalTimeoutConstant = readTotalTimeoutConstant;       // Constant in milliseconds.
-	m_timeouts.WriteTotalTimeoutMultiplier = writeTotalTimeoutMultiplier; // Multiplier of characters.
-	m_timeouts.WriteTotalTimeoutConstant = writeTotalTimeoutConstant;     // Constant in milliseconds.
-}
-
-bool PrevacSerial::establishConnection(char const* portName, DWORD baudRate)
+size_t buildPrevacFrame(uint8_t* buffer, size_t buffer_size, prevac_msg_t const& msg)
 {
-	m_hSerial = CreateFileA(
-		portName,                           // COM-port name.
-		GENERIC_READ | GENERIC_WRITE,   // R/W access.
-		0,                                 // Sharing mode (0 for serial ports).
-		NULL,                       // Default security protection.
-		OPEN_EXISTING,             // Open an existing device.
-		FILE_FLAG_OVERLAPPED,       // Async I/O.
-		NULL);                           // No template for the file.
-	if (m_hSerial == INVALID_HANDLE_VALUE)
+	// Data length occupies one byte on the line (3.1 section of the user manual).
+	if (msg.dataLen > kdefault_max_line_data_len)
 	{
 #ifdef LOG_ON
-		std::cerr << "Error: Can't open serial port. Error code: " << GetLastError() << '\n';
+		std::cerr << "Error: Can't build message, data length " << msg.dataLen << " exceeds "
+			<< static_cast<int>(kdefault_max_line_data_len) << " bytes\n";
 #endif
-		return false;
+		return 0;
 	}
+	uint8_t const dataLen{ static_cast<uint8_t>(msg.dataLen) };
 
-	m_dcbSerialParams.DCBlength = sizeof(m_dcbSerialParams);
-	if (!GetCommState(m_hSerial, &m_dcbSerialParams))
-	{
-#ifdef LOG_ON
-		std::cerr << "Error: Can't get communication state. Error code: " << GetLastError() << '\n';
-#endif
-		CloseHandle(m_hSerial);
-		m_hSerial = INVALID_HANDLE_VALUE;
-		return false;
-	}
-
-	setConnectionParameters();
-	if (!SetCommState(m_hSerial, &m_dcbSerialParams))
-	{
-#ifdef LOG_ON
-		std::cerr << "Error: Can't set communication state. Maybe connection parameters are wrong. Error code: "
-			<< GetLastError() << '\n';
-#endif
-		CloseHandle(m_hSerial);
-		m_hSerial = INVALID_HANDLE_VALUE;
-		return false;
-	}
-
-	setConnectionTimeouts();
-	if (!SetCommTimeouts(m_hSerial, &m_timeouts))
-	{
-#ifdef LOG_ON
-		std::cerr << "Error: Can't set communication timeouts. Maybe connection timeouts are wrong. Error code: "
-			<< GetLastError() << '\n';
-#endif
-		CloseHandle(m_hSerial);
-		m_hSerial = INVALID_HANDLE_VALUE;
-		return false;
-	}
-
-	return true;
-}
-
-bool PrevacSerial::writeData(const uint8_t* data, size_t size)
-{
-	DWORD bytesWritten;
-	return WriteFile(m_hSerial, data, size, &bytesWritten, NULL) && size == bytesWritten;
-}
-
-bool PrevacSerial::readData(uint8_t* buffer, size_t bufferSize, DWORD& bytesRead) { return ReadFile(m_hSerial, buffer, bufferSize, &bytesRead, NULL); }
-
-bool PrevacSerial::sendMessage(prevac_msg_t const& msg)
-{
-	size_t messageSize{ msg.size() };
-	uint8_t* buffer{ new uint8_t[messageSize] };
-
-	try
-	{
-		buildMessage_(buffer, messageSize, msg);
-		bool result{ writeData(buffer, messageSize) };
-		clearBuffer_(buffer);
-		return result;
-	}
-	catch (const std::exception& e)
+	size_t offset{};
+	if (!copyToBuffer(buffer, buffer_size, offset, &msg.header, sizeof(msg.header)) ||
+		!copyToBuffer(buffer, buffer_size, offset, &dataLen, sizeof(dataLen)) ||
+		!copyToBuffer(buffer, buffer_size, offset, &msg.deviceAddr, sizeof(msg.deviceAddr)) ||
+		!copyToBuffer(buffer, buffer_size, offset, &msg.deviceGroup, sizeof(msg.deviceGroup)) ||
+		!copyToBuffer(buffer, buffer_size, offset, &msg.logicGroup, sizeof(msg.logicGroup)) ||
+		!copyToBuffer(buffer, buffer_size, offset, &msg.driverAddr, sizeof(msg.driverAddr)) ||
+		!copyToBuffer(buffer, buffer_size, offset, &msg.functionCode, sizeof(msg.functionCode)) ||
+		!copyToBuffer(buffer, buffer_size, offset, msg.data, dataLen) ||
+		!copyToBuffer(buffer, buffer_size, offset, &msg.crc, sizeof(msg.crc)))
 	{
 #ifdef LOG_ON
-		std::cerr << "Error: Can't send message " << e.what() << '\n';
+		std::cerr << "Error: Can't build message, it doesn't fit into " << buffer_size << " bytes\n";
 #endif
-		clearBuffer_(buffer);
-		return false;
+		return 0;
 	}
+	return offset;
 }
 
-bool PrevacSerial::receiveMessage(prevac_msg_t& msg)
+bool parsePrevacFrame(uint8_t const* buffer, size_t size, prevac_msg_t& msg)
 {
-	uint8_t buffer[kdefault_max_prevac_msg_size];
-	DWORD bytesRead;
-
-	if (!readData(buffer, sizeof(buffer), bytesRead))
+	// We can recieve max 263 bytes: where 8 from it all the parts of the message without data, and 255 bytes for the data.
+	if (size < kdefault_message_parts_count_without_data) // 8 bytes is the min bytes to recieve (all the parts of the message, where data is null).
 	{
 #ifdef LOG_ON
-		std::cerr << "Error: Can't read data. Error code: " << GetLastError() << '\n';
+		std::cerr << "Error: Insufficient bytes read: " << size << " bytes\n";
 #endif
 		return false;
 	}
 
-	// We can recieve max 263 bytes: where 8 from it all the parts of the message without data, and 255 bytes for the data.
-	if (bytesRead < 9) // 9 bytes is the min bytes to recieve (all 9 parts of the message, where data is null).
+	if (buffer[0] != kdefault_header_value)
 	{
 #ifdef LOG_ON
-		std::cerr << "Error: Insufficient bytes read: " << bytesRead << " bytes\n";
+		std::cerr << "Error: Invalid header or insufficient bytes read\n";
 #endif
 		return false;
 	}
 
-	msg.header = buffer[0];
-	msg.dataLen = buffer[1];
-
-	DWORD expectedSize{ static_cast<DWORD>(kdefault_message_parts_count_without_data) + static_cast<DWORD>(msg.dataLen) };
-	if (bytesRead != expectedSize)
+	uint8_t dataLen{ buffer[1] };
+	size_t expectedSize{ static_cast<size_t>(kdefault_message_parts_count_without_data) + dataLen };
+	if (size != expectedSize)
 	{
 #ifdef LOG_ON
 		std::cerr << "Error: Bytes read doesn't match expected structure size\n";
@@ -195,30 +97,34 @@ bool PrevacSerial::receiveMessage(prevac_msg_t& msg)
 		return false;
 	}
 
-	if (buffer[0] != kdefault_header_value)
+	// Direct parsing assuming fixed-size leading fields and dynamic data field length.
+	size_t offset{};
+	if (!safeCopyFromBuffer(msg.header, offset, buffer, size) ||
+		!safeCopyFromBuffer(dataLen, offset, buffer, size) ||
+		!safeCopyFromBuffer(msg.deviceAddr, offset, buffer, size) ||
+		!safeCopyFromBuffer(msg.deviceGroup, offset, buffer, size) ||
+		!safeCopyFromBuffer(msg.logicGroup, offset, buffer, size) ||
+		!safeCopyFromBuffer(msg.driverAddr, offset, buffer, size) ||
+		!safeCopyFromBuffer(msg.functionCode, offset, buffer, size) ||
+		memcpy_s(msg.data, sizeof(msg.data), buffer + offset, dataLen) != 0)
 	{
 #ifdef LOG_ON
-		std::cerr << "Error: Invalid header or insufficient bytes read\n";
+		std::cerr << "Error: Failed to safely copy message fields\n";
 #endif
 		return false;
 	}
 
-	// Direct parsing assuming fixed-size leading fields and dynamic data field length.
-	size_t offset{};
-	size_t bufferSize{ sizeof(buffer) };
-	if (!safeCopyFromBuffer(msg.header, offset, buffer, bufferSize) ||
-		!safeCopyFromBuffer(msg.dataLen, offset, buffer, bufferSize) ||
-		!safeCopyFromBuffer(msg.deviceAddr, offset, buffer, bufferSize) ||
-		!safeCopyFromBuffer(msg.deviceGroup, offset, buffer, bufferSize) ||
-		!safeCopyFromBuffer(msg.logicGroup, offset, buffer, bufferSize) ||
-		!safeCopyFromBuffer(msg.driverAddr, offset, buffer, bufferSize) ||
-		!safeCopyFromBuffer(msg.functionCode, offset, buffer, bufferSize))
+	msg.dataLen = dataLen;
+	msg.calculateCRC();
+
+	uint8_t const receivedCrc{ buffer[offset + dataLen] };
+	if (msg.crc != receivedCrc)
 	{
 #ifdef LOG_ON
-		std::cerr << "Error: Failed to safely copy message fields\n";
+		std::cerr << "Error: CRC mismatch, received " << static_cast<int>(receivedCrc)
+			<< ", calculated " << static_cast<int>(msg.crc) << '\n';
 #endif
 		return false;
 	}
-
 	return true;
 }
@@ -1,171 +1,196 @@
 #pragma once
-#include <windows.h>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
 
+#include "LoopbackTransport.h"
 #include "PrevacMessageType.h"
+#include "PrevacTransport.h"
+#include "PseudoTerminalTransport.h"
+#include "RealTimeProfile.h"
+#include "SerialPortTransport.h"
 
-/// @brief Manages serial communication for PREVAC protocol messages.
-class PrevacSerial {
-private:
-	HANDLE m_hSerial{ INVALID_HANDLE_VALUE }; ///< Handle for the serial connection.
-	DCB m_dcbSerialParams{};                  ///< Structure containing the control settings for a serial communications device.
-	COMMTIMEOUTS m_timeouts{};                ///< Structure containing the time-out parameters for a serial communications device.
+/**
+ * @brief Constructs a PREVAC protocol message and writes it into a buffer.
+ *		  This function serializes the components of a prevac_msg_t structure into a contiguous
+ *		  block of memory, effectively creating a message ready to be sent over a serial connection.
+ *        It handles the serialization process by copying each field of the message structure
+ *        into the provided buffer, respecting the order and size of each field.
+ *
+ * @param[out] buffer Pointer to the buffer where the serialized message will be stored.
+ *                    The buffer must be large enough to hold the entire message.
+ *                    The caller is responsible for allocating and deallocating the buffer.
+ * @param buffer_size Size of the buffer.
+ *
+ * @param[in] msg The prevac_msg_t structure that contains the message data to be serialized.
+ *                This structure provides the content and format of the message according
+ *                to the PREVAC protocol specifications.
+ *
+ * @return Count of bytes written into the buffer, 0 if the message doesn't fit into the buffer
+ *         or its data length exceeds `kdefault_max_line_data_len`.
+ */
+size_t buildPrevacFrame(uint8_t* buffer, size_t buffer_size, prevac_msg_t const& msg);
 
-	/**
-	 * @brief Clears out pointer on the buffer.
-	 *		  Checks if buffer not null inside to avoid double free.
-	 *		  Clears out the pointer (sets it to `nullptr`).
-	 *
-	 * @param buffer Pointer to clear.
-	*/
-	void clearBuffer_(uint8_t* buffer);
+/**
+ * @brief Parses a PREVAC protocol message from the received bytes.
+ * @param[in] buffer Pointer to the received bytes.
+ * @param size Count of the received bytes. Must be exactly one frame.
+ * @param[out] msg Structure to store the parsed message.
+ * @return True if the bytes form a valid frame with the matching CRC, False otherwise.
+ */
+bool parsePrevacFrame(uint8_t const* buffer, size_t size, prevac_msg_t& msg);
 
-	/**
-	 * @brief Copies data from source to buffer at the specified offset and updates the offset.
-	 * @param buffer Pointer to the destination buffer.
-	 * @param buffer_size Size of the buffer.
-	 * @param offset Reference to the current offset in the buffer, will be updated after copy.
-	 * @param source Pointer to the source data to copy.
-	 * @param size Number of bytes to copy.
-	 */
-	void copyToBuffer_(uint8_t* buffer, size_t buffer_size, size_t& offset, const void* source, size_t size);
+/// @brief Outcome of one receive.
+enum class receive_status_t : uint8_t {
+	Ok,            ///< Frame was received and decoded.
+	Timeout,       ///< Nothing arrived before the read timeouts elapsed.
+	DecodeError,   ///< Bytes arrived, but they don't form a valid frame or its CRC doesn't match.
+	TransportError ///< Transport failed to read, e.g. the device was disconnected.
+};
 
-	/**
-	 * @brief Constructs a PREVAC protocol message and writes it into a buffer.
-	 *		  This method serializes the components of a prevac_msg_t structure into a contiguous
-	 *		  block of memory, effectively creating a message ready to be sent over a serial connection.
-	 *        It handles the serialization process by copying each field of the message structure
-	 *        into the provided buffer, respecting the order and size of each field.
-	 *
-	 * @param[out] buffer Pointer to the buffer where the serialized message will be stored.
-	 *                    The buffer must be large enough to hold the entire message.
-	 *                    The caller is responsible for allocating and deallocating the buffer.
-	 * @param buffer_size Size of the buffer.
-	 *
-	 * @param[in] msg The prevac_msg_t structure that contains the message data to be serialized.
-	 *                This structure provides the content and format of the message according
-	 *                to the PREVAC protocol specifications.
-	 */
-	void buildMessage_(uint8_t* buffer, size_t buffer_size, prevac_msg_t const& msg);
+/**
+ * @brief Manages communication of PREVAC protocol messages over the specified transport.
+ *
+ * Framing and message logic is independent of the byte channel, so the same code runs against
+ * the real serial port, a pseudo-terminal or the in-memory loopback.
+ *
+ * Threading contract: one writer and one reader. Message buffers are members (pre-faulted once),
+ * so `sendMessage` must not be called from two threads at the same time, nor `receiveMessage`.
+ * One thread may send while another one receives. Callers that send from several threads
+ * must serialize their `sendMessage` calls.
+ *
+ * @tparam Transport Byte channel satisfying the `PrevacTransport` concept.
+ */
+template<PrevacTransport Transport>
+class BasicPrevacSerial {
+private:
+	Transport m_transport;      ///< Byte channel to the device.
+	rt_profile_t m_rtProfile{}; ///< Real-time profile of the I/O thread.
+
+	uint8_t m_txBuffer[kdefault_max_prevac_msg_size]{}; ///< Buffer for the outgoing message. Member to be pre-faulted once, not allocated per message.
+	uint8_t m_rxBuffer[kdefault_max_prevac_msg_size]{}; ///< Buffer for the incoming message. Member to be pre-faulted once, not allocated per message.
+	bool m_buffersLocked{};                             ///< True while the message buffers are locked in RAM by the real-time profile.
+
+	/// @brief Unlocks the message buffers if the real-time profile has locked them.
+	void unlockBuffers_()
+	{
+		if (!m_buffersLocked)
+			return;
+		unlockBuffer(m_txBuffer, sizeof(m_txBuffer));
+		unlockBuffer(m_rxBuffer, sizeof(m_rxBuffer));
+		m_buffersLocked = false;
+	}
 
 public:
-	PrevacSerial() = default;
-	~PrevacSerial();
+	BasicPrevacSerial() = default;
 
-	/**
-	 * @brief Sets the connection parameters for the serial communication.
-	 *
-	 * Configures the serial port connection parameters according to the specifications provided
-	 * in the TM13/TM14 Thickness Monitor user manual. The function allows customization of data bits,
-	 * parity, stop bits, flow control, and baud rate, though the default values are aligned with the
-	 * device's requirements.
-	 *
-	 * @param dataBits Number of data bits per byte. The TM13/TM14 uses 8 data bits.
-	 * @param parity Type of parity to use. The TM13/TM14 requires None (0).
-	 *               Possible values are: NOPARITY (0), ODDPARITY (1), EVENPARITY (2),
-	 *               MARKPARITY (3), and SPACEPARITY (4).
-	 *
-	 * @param stopBits Number of stop bits to use. The TM13/TM14 uses 1 stop bit.
-	 *                 Possible values are: ONESTOPBIT (0), ONE5STOPBITS (1), and TWOSTOPBITS (2).
-	 *
-	 * @param flowControl Type of flow control to use. The TM13/TM14 requires None.
-	 *                    Specify as DWORD values corresponding to the desired flow control settings.
-	 *                    Common values include 0 (None), XON/XOFF, and RTS/CTS.
-	 *
-	 * @param baudRate Communication speed in bits per second (bps). For the TM13/TM14, this is fixed at 57600 bps.
-	 *                 Default value is CBR_57600. Other standard baud rates can be specified but may not be
-	 *                 applicable for the TM13/TM14.
-	 *
-	 * @note This function should be called to configure the serial port before attempting to communicate with
-	 *       the TM13/TM14 Thickness Monitor to ensure compatibility with the device's communication parameters.
-	 */
-	void setConnectionParameters(BYTE dataBits = 8, BYTE parity = NOPARITY, BYTE stopBits = ONE5STOPBITS,
-		DWORD flowControl = DTR_CONTROL_DISABLE, DWORD baudRate = CBR_57600);
+	/// @brief Unlocks the message buffers: page locks outlive the object otherwise.
+	~BasicPrevacSerial() { unlockBuffers_(); }
 
-	/**
-	 * @brief Sets the communication timeouts for the serial port.
-	 *
-	 * This method configures the timeout parameters for reading from and writing to the serial port,
-	 * using the _COMMTIMEOUTS structure parameters. These parameters control the behavior of read and write
-	 * operations on the serial port, specifically how the system times out read or write operations.
-	 *
-	 * @param readIntervalTimeout Maximum time, in milliseconds, allowed to elapse between the arrival
-	 *                            of two consecutive characters on the communications line. Setting to MAXDWORD
-	 *                            will disable interval timeouts if both ReadTotalTimeoutMultiplier and
-	 *                            ReadTotalTimeoutConstant are also set to MAXDWORD. A value of 0 indicates
-	 *                            that interval timeouts are not used.
-	 *
-	 * @param readTotalTimeoutMultiplier Multiplier, in milliseconds, used to calculate the total time-out
-	 *                                   period for read operations. For each read operation, this value is
-	 *                                   multiplied by the requested number of bytes to be read.
-	 *
-	 * @param readTotalTimeoutConstant A constant, in milliseconds, used to calculate the total time-out
-	 *                                 period for read operations. This value is added to the product of the
-	 *                                 ReadTotalTimeoutMultiplier member and the requested number of bytes.
-	 *
-	 * @param writeTotalTimeoutMultiplier Multiplier, in milliseconds, used to calculate the total time-out
-	 *                                    period for write operations. For each write operation, this value
-	 *                                    is multiplied by the number of bytes to be written.
-	 *
-	 * @param writeTotalTimeoutConstant A constant, in milliseconds, used to calculate the total time-out
-	 *                                  period for write operations. This value is added to the product of
-	 *                                  the WriteTotalTimeoutMultiplier member and the number of bytes to be
-	 *                                  written.
-	 *
-	 * @note A time-out occurs when a read operation does not receive the expected number of bytes within
-	 *       the time-out period calculated using the multiplier and constant values. Similarly, a time-out
-	 *       occurs when a write operation cannot transmit the specified number of bytes within the calculated
-	 *       time-out period. Adjusting these parameters can help manage the flow of data over the serial port,
-	 *       especially in applications that require precise timing control.
-	 */
-	void setConnectionTimeouts(DWORD readIntervalTimeout = 50, DWORD readTotalTimeoutMultiplier = 10,
-		DWORD readTotalTimeoutConstant = 50, DWORD writeTotalTimeoutMultiplier = 10,
-		DWORD writeTotalTimeoutConstant = 50);
+	BasicPrevacSerial(BasicPrevacSerial const&) = delete;
+	BasicPrevacSerial& operator=(BasicPrevacSerial const&) = delete;
+
+	/// @brief Returns the transport, e.g. to establish connection or to tune it.
+	Transport& transport() noexcept { return m_transport; }
+
+	/// @brief Returns the transport.
+	Transport const& transport() const noexcept { return m_transport; }
 
 	/**
-	 * @brief Establishes a serial connection to a specified port with a given baud rate.
+	 * @brief Sets the real-time profile of the I/O path.
 	 *
-	 * Default connection parameters from the user manual (TM13/TM14 Thickness Monitor).
-	 * 3.2 Connection parameters:
-	 *    Data bits: 8
-	 *    Parity: None
-	 *    Stop bits: 1
-	 *    Flow control: None
-	 *    Baud rate: 57600 (fixed value)
+	 * Applies CPU affinity, real-time priority and memory locking to the calling thread, so it must be
+	 * called from the thread that performs `readData`/`writeData` (or `sendMessage`/`receiveMessage`).
+	 * Also pre-faults the message buffers and, if the transport supports it, switches the read path
+	 * between blocking and busy-poll waits.
 	 *
-	 * @param portName Name of the port to connect to (e.g., "COM1", "COM2", etc.).
-	 * @param baudRate Baud rate for the connection.
-	 * @return True if connection was successfully established, False otherwise.
+	 * @param profile Real-time profile to apply.
+	 * @return True if the whole profile was applied, False otherwise. The wait mode is switched even if
+	 *         the OS refused some of the scheduling settings.
 	 */
-	bool establishConnection(char const* portName, DWORD baudRate = CBR_57600);
+	bool setRealTimeProfile(rt_profile_t const& profile)
+	{
+		m_rtProfile = profile;
+
+		bool result{ applyRealTimeProfile(profile) };
+
+		// Locks of the previous profile are released if this one doesn't lock the buffers.
+		if (!profile.prefaultBuffers || !profile.lockMemory)
+			unlockBuffers_();
+		if (profile.prefaultBuffers)
+		{
+			result &= prefaultBuffer(m_txBuffer, sizeof(m_txBuffer), profile.lockMemory);
+			result &= prefaultBuffer(m_rxBuffer, sizeof(m_rxBuffer), profile.lockMemory);
+			m_buffersLocked = m_buffersLocked || profile.lockMemory;
+		}
+		if constexpr (WaitModeConfigurableTransport<Transport>)
+			result &= m_transport.setWaitMode(profile.waitMode, profile.busyPollTimeoutUs);
+		return result;
+	}
+
+	/// @brief Returns the current real-time profile of the I/O path.
+	rt_profile_t const& realTimeProfile() const noexcept { return m_rtProfile; }
 
 	/**
-	 * @brief Writes data to the serial port.
+	 * @brief Writes data to the transport.
 	 * @param data Pointer to the data to write.
 	 * @param size Number of bytes to write.
 	 * @return True if data was successfully written, False otherwise.
 	 */
-	bool writeData(const uint8_t* data, size_t size);
+	bool writeData(uint8_t const* data, size_t size) { return m_transport.write(data, size); }
 
 	/**
-	 * @brief Reads data from the serial port.
+	 * @brief Reads data from the transport.
 	 * @param buffer Pointer to the buffer to store read data.
 	 * @param bufferSize Size of the buffer, indicating max bytes to read.
-	 * @param bytesRead Reference to DWORD to store the number of bytes actually read.
+	 * @param bytesRead Reference to store the number of bytes actually read.
 	 * @return True if data was successfully read, False otherwise.
 	 */
-	bool readData(uint8_t* buffer, size_t bufferSize, DWORD& bytesRead);
+	bool readData(uint8_t* buffer, size_t bufferSize, size_t& bytesRead) { return m_transport.read(buffer, bufferSize, bytesRead); }
 
 	/**
-	 * @brief Sends a PREVAC protocol message over the serial connection.
+	 * @brief Sends a PREVAC protocol message over the transport.
+	 * @note Not reentrant: uses the member tx buffer, only one thread may send at a time.
 	 * @param msg The PREVAC protocol message to send.
 	 * @return True if the message was successfully sent, False otherwise.
 	 */
-	bool sendMessage(prevac_msg_t const& msg);
+	bool sendMessage(prevac_msg_t const& msg)
+	{
+		size_t messageSize{ buildPrevacFrame(m_txBuffer, sizeof(m_txBuffer), msg) };
+		if (messageSize == 0)
+			return false;
+		return writeData(m_txBuffer, messageSize);
+	}
 
 	/**
-	 * @brief Receives a PREVAC protocol message over the serial connection.
+	 * @brief Receives a PREVAC protocol message over the transport, telling why nothing was received.
+	 * @note Not reentrant: uses the member rx buffer, only one thread may receive at a time.
+	 * @param msg Reference to a prevac_msg_t structure to store the received message.
+	 * @return Ok if a message was received, otherwise the reason it wasn't.
+	 */
+	receive_status_t tryReceiveMessage(prevac_msg_t& msg)
+	{
+		size_t bytesRead{};
+		if (!readData(m_rxBuffer, sizeof(m_rxBuffer), bytesRead))
+		{
+#ifdef LOG_ON
+			std::cerr << "Error: Can't read data\n";
+#endif
+			return receive_status_t::TransportError;
+		}
+		if (bytesRead == 0)
+			return receive_status_t::Timeout;
+		return parsePrevacFrame(m_rxBuffer, bytesRead, msg) ? receive_status_t::Ok : receive_status_t::DecodeError;
+	}
+
+	/**
+	 * @brief Receives a PREVAC protocol message over the transport.
+	 * @note Not reentrant: uses the member rx buffer, only one thread may receive at a time.
 	 * @param msg Reference to a prevac_msg_t structure to store the received message.
 	 * @return True if a message was successfully received, False otherwise.
 	 */
-	bool receiveMessage(prevac_msg_t& msg);
+	bool receiveMessage(prevac_msg_t& msg) { return tryReceiveMessage(msg) == receive_status_t::Ok; }
 };
+
+/// @brief PREVAC protocol over the serial port: Win32 COM port or POSIX tty.
+using PrevacSerial = BasicPrevacSerial<SerialPortTransport>;
@@ -0,0 +1,48 @@
+#pragma once
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+
+#include "RealTimeProfile.h"
+
+/**
+ * @brief Requirements to the transport (byte channel) used by `BasicPrevacSerial`.
+ *
+ * The transport is a template parameter of `BasicPrevacSerial`, so all the calls are resolved at compile time
+ * and there is no virtual dispatch on the hot path.
+ *
+ * `write` must send all the bytes, returning False otherwise.
+ * `read` must store up to `bufferSize` bytes, returning False only on error. A read that timed out
+ * returns True with `bytesRead` set to 0. One read is expected to return one frame: like a serial port
+ * with an interval timeout, the transport stops reading on a gap between frames.
+ */
+template<typename T>
+concept PrevacTransport = requires(T & transport, uint8_t const* data, uint8_t * buffer, size_t size, size_t & bytesRead) {
+	{ transport.write(data, size) } -> std::same_as<bool>;
+	{ transport.read(buffer, size, bytesRead) } -> std::same_as<bool>;
+};
+
+/**
+ * @struct link_timeouts_t
+ * @brief Read timeouts of the link, same meaning as the read members of the Win32 COMMTIMEOUTS.
+ *        Total timeout of one read is `readTotalTimeoutMultiplierMs` * requested bytes + `readTotalTimeoutConstantMs`.
+ */
+struct link_timeouts_t {
+	uint32_t readIntervalTimeoutMs{};        ///< Max gap between two bytes of one read. 0 disables it.
+	uint32_t readTotalTimeoutMultiplierMs{}; ///< Per-byte part of the total read timeout.
+	uint32_t readTotalTimeoutConstantMs{};   ///< Constant part of the total read timeout.
+};
+
+/// @brief Transport that supports blocking and busy-poll waits of the real-time profile.
+template<typename T>
+concept WaitModeConfigurableTransport = PrevacTransport<T> && requires(T & transport, io_wait_mode_t waitMode, uint32_t busyPollTimeoutUs) {
+	{ transport.setWaitMode(waitMode, busyPollTimeoutUs) } -> std::same_as<bool>;
+};
+
+/// @brief Transport which baud rate and read timeouts can be changed on the fly, e.g. by the link calibration.
+template<typename T>
+concept CalibratableTransport = PrevacTransport<T> && requires(T & transport, uint32_t baudRate, link_timeouts_t const& timeouts) {
+	{ transport.setBaudRate(baudRate) } -> std::same_as<bool>;
+	{ transport.setLinkTimeouts(timeouts) } -> std::same_as<bool>;
+	{ transport.linkTimeouts() } -> std::same_as<link_timeouts_t>;
+};
@@ -0,0 +1,75 @@
+#ifndef _WIN32
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "PseudoTerminalTransport.h"
+
+void PseudoTerminalTransport::close_()
+{
+	if (m_peerFd != -1)
+	{
+		::close(m_peerFd);
+		m_peerFd = -1;
+	}
+	TtyTransport::close_();
+	m_peerName.clear();
+}
+
+PseudoTerminalTransport::~PseudoTerminalTransport() { close_(); }
+
+bool PseudoTerminalTransport::open()
+{
+	close_();
+
+	m_fd = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+	if (m_fd == -1 || grantpt(m_fd) != 0 || unlockpt(m_fd) != 0)
+	{
+#ifdef LOG_ON
+		std::cerr << "Error: Can't create pseudo-terminal: " << std::strerror(errno) << '\n';
+#endif
+		close_();
+		return false;
+	}
+
+	char const* peerName{ ptsname(m_fd) };
+	if (!peerName)
+	{
+#ifdef LOG_ON
+		std::cerr << "Error: Can't get name of the pseudo-terminal peer: " << std::strerror(errno) << '\n';
+#endif
+		close_();
+		return false;
+	}
+	m_peerName = peerName;
+
+	// Linux master reads fail with EIO while no descriptor of the peer is opened: holding one ourselves.
+	m_peerFd = ::open(peerName, O_RDWR | O_NOCTTY | O_NONBLOCK);
+	if (m_peerFd == -1)
+	{
+#ifdef LOG_ON
+		std::cerr << "Error: Can't open pseudo-terminal peer " << m_peerName << ": " << std::strerror(errno) << '\n';
+#endif
+		close_();
+		return false;
+	}
+
+	// Attributes of the pty pair are shared, so the raw mode set here applies to the peer as well.
+	if (!configure_())
+	{
+		close_();
+		return false;
+	}
+	return true;
+}
+
+bool PseudoTerminalTransport::establishConnection(char const* path)
+{
+	close_();
+	return open_(path) && configure_();
+}
+#endif
@@ -0,0 +1,43 @@
+#pragma once
+#ifndef _WIN32
+#include <string>
+
+#include "TtyTransport.h"
+
+/**
+ * @brief Transport over a POSIX pseudo-terminal.
+ *
+ * Lets the stack talk to a device simulator through a pty pair: one side creates the pair by `open`
+ * and passes `peerName` to the simulator, or connects to a pty created by the simulator by `establishConnection`.
+ * Only the raw mode is set, line parameters mean nothing to a pty: use `SerialPortTransport` for real serial ports.
+ * Windows has no pseudo-terminals for byte streams, use `SerialPortTransport` with a virtual COM port pair there.
+ */
+class PseudoTerminalTransport : public TtyTransport {
+private:
+	int m_peerFd{ -1 };      ///< Own descriptor of the peer side of the pair created by `open`, never read. Keeps the master from EIO while the simulator hasn't opened the peer or has closed it.
+	std::string m_peerName;  ///< Path of the other side of the pty pair created by `open`.
+
+	/// @brief Closes the pty and the own peer descriptor if they are opened.
+	void close_();
+
+public:
+	PseudoTerminalTransport() = default;
+	~PseudoTerminalTransport();
+
+	/**
+	 * @brief Creates a new pseudo-terminal pair, this transport owns the master side.
+	 * @return True if the pair was created, False otherwise.
+	 */
+	bool open();
+
+	/**
+	 * @brief Opens an existing pseudo-terminal (e.g. created by a device simulator) in raw mode.
+	 * @param path Path of the pty, e.g. "/dev/pts/3".
+	 * @return True if the pty was opened, False otherwise.
+	 */
+	bool establishConnection(char const* path);
+
+	/// @brief Returns path of the other side of the pair created by `open`, empty otherwise.
+	std::string const& peerName() const noexcept { return m_peerName; }
+};
+#endif
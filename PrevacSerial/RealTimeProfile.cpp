@@ -0,0 +1,280 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <timeapi.h>
+#ifdef _MSC_VER
+#pragma comment(lib, "winmm.lib")
+#endif
+#else
+#include <cerrno>
+#include <cstring>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "RealTimeProfile.h"
+
+#ifdef _WIN32
+static constexpr SIZE_T const kdefault_working_set_growth{ 16 * 1024 * 1024 }; ///< Working set is grown by 16 MiB to let VirtualLock succeed.
+static constexpr UINT const kdefault_timer_resolution_ms{ 1 };                 ///< System timer resolution requested while the jitter self-test sleeps.
+#endif
+
+static size_t pageSize()
+{
+#ifdef _WIN32
+	SYSTEM_INFO info{};
+	GetSystemInfo(&info);
+	return static_cast<size_t>(info.dwPageSize);
+#else
+	long size{ sysconf(_SC_PAGESIZE) };
+	return size > 0 ? static_cast<size_t>(size) : 4096;
+#endif
+}
+
+/// @brief Returns value of the sorted samples at the specified percentile [0; 100].
+static double percentile(std::vector<double> const& sorted, double pct)
+{
+	if (sorted.empty())
+		return 0.0;
+
+	size_t idx{ static_cast<size_t>(std::ceil(pct / 100.0 * static_cast<double>(sorted.size()))) };
+	return sorted[std::clamp<size_t>(idx, 1, sorted.size()) - 1];
+}
+
+static bool setAffinity(uint64_t mask)
+{
+#ifdef _WIN32
+	if (!SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(mask)))
+	{
+#ifdef LOG_ON
+		std::cerr << "Error: Can't set thread affinity. Error code: " << GetLastError() << '\n';
+#endif
+		return false;
+	}
+#else
+	cpu_set_t cpuSet;
+	CPU_ZERO(&cpuSet);
+	for (int cpu{}; cpu < 64 && cpu < CPU_SETSIZE; ++cpu)
+		if (mask & (uint64_t{ 1 } << cpu))
+			CPU_SET(cpu, &cpuSet);
+
+	int err{ pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) };
+	if (err != 0)
+	{
+#ifdef LOG_ON
+		std::cerr << "Error: Can't set thread affinity: " << std::strerror(err) << '\n';
+#endif
+		return false;
+	}
+#endif
+	return true;
+}
+
+static bool setRealTimePriority(int priority)
+{
+#ifdef _WIN32
+	// Only the calling thread is raised: priority class of the process would apply to every thread of it,
+	// including the ones doing slow non-real-time work, which could then starve the system.
+	if (!SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL))
+	{
+#ifdef LOG_ON
+		std::cerr << "Error: Can't set thread priority. Error code: " << GetLastError() << '\n';
+#endif
+		return false;
+	}
+
+	// The OS may apply a lower priority than requested without failing the call.
+	int const applied{ GetThreadPriority(GetCurrentThread()) };
+	if (applied != THREAD_PRIORITY_TIME_CRITICAL)
+	{
+#ifdef LOG_ON
+		std::cerr << "Error: Thread priority " << THREAD_PRIORITY_TIME_CRITICAL << " was requested, " << applied << " was applied\n";
+#endif
+		return false;
+	}
+#else
+	sched_param param{};
+	param.sched_priority = std::clamp(priority, sched_get_priority_min(SCHED_FIFO), sched_get_priority_max(SCHED_FIFO));
+
+	int err{ pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) };
+	if (err != 0)
+	{
+#ifdef LOG_ON
+		std::cerr << "Error: Can't set SCHED_FIFO priority " << param.sched_priority << ": " << std::strerror(err) << '\n';
+#endif
+		return false;
+	}
+#endif
+	return true;
+}
+
+static bool lockProcessMemory()
+{
+#ifdef _WIN32
+	// Windows has no mlockall(): grow the working set, so that pages locked by VirtualLock() fit into it.
+	SIZE_T minSize{}, maxSize{};
+	if (!GetProcessWorkingSetSize(GetCurrentProcess(), &minSize, &maxSize) ||
+		!SetProcessWorkingSetSize(GetCurrentProcess(), minSize + kdefault_working_set_growth, maxSize + kdefault_working_set_growth))
+	{
+#ifdef LOG_ON
+		std::cerr << "Error: Can't grow process working set. Error code: " << GetLastError() << '\n';
+#endif
+		return false;
+	}
+#else
+	if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+	{
+#ifdef LOG_ON
+		std::cerr << "Error: Can't lock process memory: " << std::strerror(errno) << '\n';
+#endif
+		return false;
+	}
+#endif
+	return true;
+}
+
+void jitter_report_t::print() const
+{
+	std::cout << "Jitter self-test, samples: " << samples << std::endl
+		<< "  min:   " << minUs << " us" << std::endl
+		<< "  p50:   " << p50Us << " us" << std::endl
+		<< "  p90:   " << p90Us << " us" << std::endl
+		<< "  p99:   " << p99Us << " us" << std::endl
+		<< "  p99.9: " << p999Us << " us" << std::endl
+		<< "  max:   " << maxUs << " us" << std::endl;
+}
+
+bool applyRealTimeProfile(rt_profile_t const& profile)
+{
+	bool result{ true };
+	if (profile.cpuAffinityMask != 0)
+		result &= setAffinity(profile.cpuAffinityMask);
+	if (profile.priority > 0)
+		result &= setRealTimePriority(profile.priority);
+	if (profile.lockMemory)
+		result &= lockProcessMemory();
+	return result;
+}
+
+bool prefaultBuffer(void* buffer, size_t size, bool lock)
+{
+	if (!buffer || size == 0)
+		return false;
+
+	// Read and write back one byte of every page: forces the page to be mapped without changing its content.
+	volatile uint8_t* bytes{ static_cast<volatile uint8_t*>(buffer) };
+	size_t const step{ pageSize() };
+	for (size_t i{}; i < size; i += step)
+		bytes[i] = bytes[i];
+	bytes[size - 1] = bytes[size - 1];
+
+	if (!lock)
+		return true;
+
+#ifdef _WIN32
+	if (!VirtualLock(buffer, size))
+	{
+#ifdef LOG_ON
+		std::cerr << "Error: Can't lock buffer in memory. Error code: " << GetLastError() << '\n';
+#endif
+		return false;
+	}
+#else
+	if (mlock(buffer, size) != 0)
+	{
+#ifdef LOG_ON
+		std::cerr << "Error: Can't lock buffer in memory: " << std::strerror(errno) << '\n';
+#endif
+		return false;
+	}
+#endif
+	return true;
+}
+
+bool unlockBuffer(void* buffer, size_t size)
+{
+	if (!buffer || size == 0)
+		return false;
+
+#ifdef _WIN32
+	if (!VirtualUnlock(buffer, size))
+	{
+#ifdef LOG_ON
+		std::cerr << "Error: Can't unlock buffer. Error code: " << GetLastError() << '\n';
+#endif
+		return false;
+	}
+#else
+	if (munlock(buffer, size) != 0)
+	{
+#ifdef LOG_ON
+		std::cerr << "Error: Can't unlock buffer: " << std::strerror(errno) << '\n';
+#endif
+		return false;
+	}
+#endif
+	return true;
+}
+
+jitter_report_t runJitterSelfTest(size_t samples, uint32_t periodUs, io_wait_mode_t waitMode)
+{
+	using clock = std::chrono::steady_clock;
+
+	// Resizing zero-fills (pre-faults) the storage, clearing keeps the capacity: no allocations while measuring.
+	std::vector<double> latencies(samples);
+	latencies.clear();
+
+#ifdef _WIN32
+	// Sleeps end on the system timer tick, 15.6 ms by default: without raising its resolution
+	// the blocking mode would measure the tick, not the scheduler.
+	bool const timerRaised{ waitMode == io_wait_mode_t::Blocking && timeBeginPeriod(kdefault_timer_resolution_ms) == TIMERR_NOERROR };
+#endif
+
+	auto const period{ std::chrono::microseconds(periodUs) };
+	auto wakeUp{ clock::now() + period };
+	for (size_t i{}; i < samples; ++i)
+	{
+		if (waitMode == io_wait_mode_t::BusyPoll)
+			while (clock::now() < wakeUp)
+				;
+		else
+			std::this_thread::sleep_until(wakeUp);
+
+		auto const now{ clock::now() };
+		latencies.emplace_back(std::chrono::duration<double, std::micro>(now - wakeUp).count());
+
+		// Planning from the actual moment: one late wake-up must not turn into a burst of the next ones.
+		wakeUp = now + period;
+	}
+
+#ifdef _WIN32
+	if (timerRaised)
+		timeEndPeriod(kdefault_timer_resolution_ms);
+#endif
+
+	std::sort(latencies.begin(), latencies.end());
+
+	jitter_report_t report;
+	report.samples = latencies.size();
+	if (!latencies.empty())
+	{
+		report.minUs = latencies.front();
+		report.maxUs = latencies.back();
+	}
+	report.p50Us = percentile(latencies, 50.0);
+	report.p90Us = percentile(latencies, 90.0);
+	report.p99Us = percentile(latencies, 99.0);
+	report.p999Us = percentile(latencies, 99.9);
+	return report;
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+/// @brief Defines how the I/O thread waits for incoming bytes.
+enum class io_wait_mode_t : uint8_t {
+	Blocking, ///< Read call sleeps inside the OS until bytes arrive or the read timeouts elapse.
+	BusyPoll  ///< Read call returns immediately and the I/O thread spins until bytes arrive.
+};
+
+static constexpr uint32_t const kdefault_busy_poll_timeout_us{ 50'000 };  ///< Busy-poll gives up after 50 ms, same as the default read total timeout constant.
+static constexpr size_t const kdefault_jitter_samples{ 10'000 };          ///< Default count of wake-ups measured by the jitter self-test.
+static constexpr uint32_t const kdefault_jitter_period_us{ 1'000 };       ///< Default period between two wake-ups of the jitter self-test.
+
+/**
+ * @struct rt_profile_t
+ * @brief Real-time profile of the thread that performs serial I/O.
+ *
+ * Every field has a "leave as is" default, so the empty profile changes nothing.
+ */
+struct rt_profile_t {
+	uint64_t cpuAffinityMask{};                          ///< Bit mask of CPUs the I/O thread is pinned to. 0 leaves affinity untouched.
+	int priority{};                                      ///< Real-time priority. Linux: SCHED_FIFO priority [1; 99]. Windows: any positive value selects THREAD_PRIORITY_TIME_CRITICAL of the thread, the process priority class is left as is. 0 leaves scheduling untouched.
+	bool lockMemory{};                                   ///< Locks process memory in RAM (mlockall on Linux, grown working set on Windows).
+	bool prefaultBuffers{ true };                        ///< Touches (and locks if `lockMemory` is set) I/O buffers up front, so the first frame doesn't page-fault.
+	io_wait_mode_t waitMode{ io_wait_mode_t::Blocking }; ///< How the read path waits for incoming bytes.
+	uint32_t busyPollTimeoutUs{ kdefault_busy_poll_timeout_us }; ///< Max time of spinning in the busy-poll mode before read gives up, used only if the link has no read total timeout.
+};
+
+/**
+ * @struct jitter_report_t
+ * @brief Wake-up latency percentiles measured by `runJitterSelfTest`.
+ *        Latency is the time between the planned wake-up moment and the moment the thread actually ran.
+ */
+struct jitter_report_t {
+	size_t samples{}; ///< Count of measured wake-ups.
+	double minUs{};   ///< Minimal wake-up latency in microseconds.
+	double p50Us{};   ///< Median wake-up latency in microseconds.
+	double p90Us{};   ///< 90th percentile of wake-up latency in microseconds.
+	double p99Us{};   ///< 99th percentile of wake-up latency in microseconds.
+	double p999Us{};  ///< 99.9th percentile of wake-up latency in microseconds.
+	double maxUs{};   ///< Maximal wake-up latency in microseconds.
+
+	/// @brief Prints the report in a readable format, one percentile per line.
+	void print() const;
+};
+
+/**
+ * @brief Applies the real-time profile to the calling thread.
+ *
+ * Sets CPU affinity, real-time scheduling and memory locking according to the profile.
+ * All the settings are applied even if one of them fails, so that the caller gets as much
+ * of the profile as the OS permits (e.g. SCHED_FIFO requires CAP_SYS_NICE on Linux).
+ *
+ * @param profile Real-time profile to apply.
+ * @return True if all the requested settings were applied, False otherwise.
+ */
+bool applyRealTimeProfile(rt_profile_t const& profile);
+
+/**
+ * @brief Pre-faults the buffer: touches every page of it, so page faults happen now and not on the hot path.
+ * @param buffer Pointer to the buffer.
+ * @param size Size of the buffer in bytes.
+ * @param lock If true, additionally locks pages of the buffer in RAM (mlock/VirtualLock).
+ * @return True if the buffer was pre-faulted (and locked if requested), False otherwise.
+ */
+bool prefaultBuffer(void* buffer, size_t size, bool lock);
+
+/**
+ * @brief Unlocks pages of the buffer locked by `prefaultBuffer` (munlock/VirtualUnlock).
+ *        Must be called before the buffer is freed, locks aren't released with it.
+ * @param buffer Pointer to the buffer.
+ * @param size Size of the buffer in bytes.
+ * @return True if the buffer was unlocked, False otherwise.
+ */
+bool unlockBuffer(void* buffer, size_t size);
+
+/**
+ * @brief Measures wake-up latency of the calling thread.
+ *
+ * Wakes up every `periodUs` microseconds, either by sleeping or by spinning depending on `waitMode`,
+ * and records how late the thread got control. Apply the real-time profile before calling this
+ * to check determinism of the machine with exactly the settings used by the I/O thread.
+ * On Windows the blocking mode raises the system timer resolution to 1 ms for the duration of the test.
+ *
+ * @param samples Count of wake-ups to measure.
+ * @param periodUs Period between two wake-ups in microseconds.
+ * @param waitMode Blocking sleeps until the planned moment, BusyPoll spins until it.
+ * @return Wake-up latency percentiles.
+ */
+jitter_report_t runJitterSelfTest(size_t samples = kdefault_jitter_samples, uint32_t periodUs = kdefault_jitter_period_us,
+	io_wait_mode_t waitMode = io_wait_mode_t::Blocking);
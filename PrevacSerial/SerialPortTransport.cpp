@@ -0,0 +1,244 @@
+#ifdef _WIN32
+#include <chrono>
+#include <iostream>
+
+#include "SerialPortTransport.h"
+
+bool SerialPortTransport::applyWaitMode_()
+{
+	COMMTIMEOUTS timeouts{ m_timeouts };
+	if (m_waitMode == io_wait_mode_t::BusyPoll)
+	{
+		// MAXDWORD interval with zero total timeouts makes ReadFile return immediately, even if nothing was received.
+		timeouts.ReadIntervalTimeout = MAXDWORD;
+		timeouts.ReadTotalTimeoutMultiplier = 0;
+		timeouts.ReadTotalTimeoutConstant = 0;
+	}
+
+	if (!SetCommTimeouts(m_hSerial, &timeouts))
+	{
+#ifdef LOG_ON
+		std::cerr << "Error: Can't set communication timeouts. Maybe connection timeouts are wrong. Error code: "
+			<< GetLastError() << '\n';
+#endif
+		return false;
+	}
+	return true;
+}
+
+SerialPortTransport::~SerialPortTransport()
+{
+	if (m_hSerial != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(m_hSerial);
+		m_hSerial = INVALID_HANDLE_VALUE;
+	}
+}
+
+void SerialPortTransport::setConnectionParameters(BYTE dataBits, BYTE parity, BYTE stopBits, DWORD flowControl, DWORD baudRate)
+{
+	m_dcbSerialParams.ByteSize = dataBits;       // Data bits.
+	m_dcbSerialParams.Parity = parity;           // None parity.
+	m_dcbSerialParams.StopBits = stopBits;       // Stop bits.
+	m_dcbSerialParams.fDtrControl = flowControl; // None flow control.
+	m_dcbSerialParams.BaudRate = baudRate;       // 57600 baud rate.
+}
+
+void SerialPortTransport::setConnectionTimeouts(DWORD readIntervalTimeout, DWORD readTotalTimeoutMultiplier, DWORD readTotalTimeoutConstant, DWORD writeTotalTimeoutMultiplier, DWORD writeTotalTimeoutConstant)
+{
+	m_timeouts.ReadIntervalTimeout = readIntervalTimeout;                 // Maximum time between read chars.
+	m_timeouts.ReadTotalTimeoutMultiplier = readTotalTimeoutMultiplier;   // Multiplier of characters.
+	m_timeouts.ReadTotalTimeoutConstant = readTotalTimeoutConstant;       // Constant in milliseconds.
+	m_timeouts.WriteTotalTimeoutMultiplier = writeTotalTimeoutMultiplier; // Multiplier of characters.
+	m_timeouts.WriteTotalTimeoutConstant = writeTotalTimeoutConstant;     // Constant in milliseconds.
+}
+
+bool SerialPortTransport::establishConnection(char const* portName, DWORD baudRate)
+{
+	m_hSerial = CreateFileA(
+		portName,                           // COM-port name.
+		GENERIC_READ | GENERIC_WRITE,   // R/W access.
+		0,                                 // Sharing mode (0 for serial ports).
+		NULL,                       // Default security protection.
+		OPEN_EXISTING,             // Open an existing device.
+		FILE_FLAG_OVERLAPPED,       // Async I/O.
+		NULL);                           // No template for the file.
+	if (m_hSerial == INVALID_HANDLE_VALUE)
+	{
+#ifdef LOG_ON
+		std::cerr << "Error: Can't open serial port. Error code: " << GetLastError() << '\n';
+#endif
+		return false;
+	}
+
+	m_dcbSerialParams.DCBlength = sizeof(m_dcbSerialParams);
+	if (!GetCommState(m_hSerial, &m_dcbSerialParams))
+	{
+#ifdef LOG_ON
+		std::cerr << "Error: Can't get communication state. Error code: " << GetLastError() << '\n';
+#endif
+		CloseHandle(m_hSerial);
+		m_hSerial = INVALID_HANDLE_VALUE;
+		return false;
+	}
+
+	setConnectionParameters(8, NOPARITY, ONE5STOPBITS, DTR_CONTROL_DISABLE, baudRate);
+	if (!SetCommState(m_hSerial, &m_dcbSerialParams))
+	{
+#ifdef LOG_ON
+		std::cerr << "Error: Can't set communication state. Maybe connection parameters are wrong. Error code: "
+			<< GetLastError() << '\n';
+#endif
+		CloseHandle(m_hSerial);
+		m_hSerial = INVALID_HANDLE_VALUE;
+		return false;
+	}
+
+	if (!applyWaitMode_())
+	{
+		CloseHandle(m_hSerial);
+		m_hSerial = INVALID_HANDLE_VALUE;
+		return false;
+	}
+
+	return true;
+}
+
+bool SerialPortTransport::setBaudRate(uint32_t baudRate)
+{
+	if (m_hSerial == INVALID_HANDLE_VALUE)
+	{
+#ifdef LOG_ON
+		std::cerr << "Error: Can't set baud rate, serial port isn't opened\n";
+#endif
+		return false;
+	}
+
+	m_dcbSerialParams.BaudRate = baudRate;
+	if (!SetCommState(m_hSerial, &m_dcbSerialParams))
+	{
+#ifdef LOG_ON
+		std::cerr << "Error: Can't set baud rate " << baudRate << ". Error code: " << GetLastError() << '\n';
+#endif
+		return false;
+	}
+
+	PurgeComm(m_hSerial, PURGE_RXCLEAR | PURGE_TXCLEAR);
+	return true;
+}
+
+bool SerialPortTransport::setLinkTimeouts(link_timeouts_t const& timeouts)
+{
+	m_timeouts.ReadIntervalTimeout = timeouts.readIntervalTimeoutMs;
+	m_timeouts.ReadTotalTimeoutMultiplier = timeouts.readTotalTimeoutMultiplierMs;
+	m_timeouts.ReadTotalTimeoutConstant = timeouts.readTotalTimeoutConstantMs;
+
+	// If the port isn't opened yet, `establishConnection` applies them.
+	return m_hSerial == INVALID_HANDLE_VALUE || applyWaitMode_();
+}
+
+bool SerialPortTransport::setWaitMode(io_wait_mode_t waitMode, uint32_t busyPollTimeoutUs)
+{
+	m_waitMode = waitMode;
+	m_busyPollTimeoutUs = busyPollTimeoutUs;
+
+	// If the port isn't opened yet, `establishConnection` applies the wait mode itself.
+	return m_hSerial == INVALID_HANDLE_VALUE || applyWaitMode_();
+}
+
+bool SerialPortTransport::write(uint8_t const* data, size_t size)
+{
+	DWORD bytesWritten{};
+	return WriteFile(m_hSerial, data, static_cast<DWORD>(size), &bytesWritten, NULL) && size == bytesWritten;
+}
+
+bool SerialPortTransport::read(uint8_t* buffer, size_t bufferSize, size_t& bytesRead)
+{
+	bytesRead = 0;
+	if (m_waitMode != io_wait_mode_t::BusyPoll)
+	{
+		DWORD chunkSize{};
+		bool result{ ReadFile(m_hSerial, buffer, static_cast<DWORD>(bufferSize), &chunkSize, NULL) != FALSE };
+		bytesRead = chunkSize;
+		return result;
+	}
+
+	using clock = std::chrono::steady_clock;
+	// Total timeout of the link bounds the spinning as it bounds the blocking wait, the busy-poll one is only a fallback.
+	auto const totalTimeout{ std::chrono::milliseconds(static_cast<uint64_t>(m_timeouts.ReadTotalTimeoutMultiplier) * bufferSize +
+		m_timeouts.ReadTotalTimeoutConstant) };
+	auto const deadline{ clock::now() + (totalTimeout.count() != 0 ? std::chrono::duration_cast<std::chrono::microseconds>(totalTimeout)
+		: std::chrono::microseconds(m_busyPollTimeoutUs)) };
+	auto const interval{ std::chrono::milliseconds(m_timeouts.ReadIntervalTimeout) };
+	clock::time_point lastByteTime;
+
+	// Spinning on the non-blocking ReadFile, emulating interval and total timeouts of the blocking mode.
+	while (bytesRead < bufferSize)
+	{
+		DWORD chunkSize{};
+		if (!ReadFile(m_hSerial, buffer + bytesRead, static_cast<DWORD>(bufferSize - bytesRead), &chunkSize, NULL))
+			return false;
+
+		auto const now{ clock::now() };
+		if (chunkSize > 0)
+		{
+			bytesRead += chunkSize;
+			lastByteTime = now;
+		}
+		else if (now >= deadline ||
+			(bytesRead > 0 && m_timeouts.ReadIntervalTimeout != 0 && now - lastByteTime >= interval))
+			break;
+	}
+	return true;
+}
+#else
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#include <termios.h>
+
+#include "SerialPortTransport.h"
+
+bool SerialPortTransport::establishConnection(char const* portName, uint32_t baudRate)
+{
+	if (!open_(portName) || !configure_())
+		return false;
+
+	termios tty{};
+	if (tcgetattr(m_fd, &tty) != 0)
+	{
+#ifdef LOG_ON
+		std::cerr << "Error: Can't get serial port attributes: " << std::strerror(errno) << '\n';
+#endif
+		close_();
+		return false;
+	}
+
+	// 8 data bits, no parity, 1 stop bit, no flow control. Reads never block in the driver, `read` does the waiting.
+	tty.c_cflag &= ~(CSIZE | PARENB | CSTOPB);
+#ifdef CRTSCTS
+	tty.c_cflag &= ~CRTSCTS;
+#endif
+	tty.c_cflag |= CS8 | CREAD | CLOCAL;
+	tty.c_iflag &= ~(IXON | IXOFF | IXANY);
+	tty.c_cc[VMIN] = 0;
+	tty.c_cc[VTIME] = 0;
+	if (tcsetattr(m_fd, TCSANOW, &tty) != 0)
+	{
+#ifdef LOG_ON
+		std::cerr << "Error: Can't set serial port attributes. Maybe connection parameters are wrong: "
+			<< std::strerror(errno) << '\n';
+#endif
+		close_();
+		return false;
+	}
+
+	if (!setBaudRate(baudRate))
+	{
+		close_();
+		return false;
+	}
+	return true;
+}
+#endif
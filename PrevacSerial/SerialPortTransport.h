@@ -0,0 +1,220 @@
+#pragma once
+#ifdef _WIN32
+// windows.h defines min/max macros breaking std::min/std::max in every file that includes this one.
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+
+#include "PrevacTransport.h"
+#include "RealTimeProfile.h"
+
+/// @brief Transport over the Win32 serial port (COM port).
+class SerialPortTransport {
+private:
+	HANDLE m_hSerial{ INVALID_HANDLE_VALUE }; ///< Handle for the serial connection.
+	DCB m_dcbSerialParams{};                  ///< Structure containing the control settings for a serial communications device.
+	COMMTIMEOUTS m_timeouts{ 50, 10, 50, 10, 50 }; ///< Structure containing the time-out parameters for a serial communications device. Defaults of `setConnectionTimeouts`.
+	io_wait_mode_t m_waitMode{ io_wait_mode_t::Blocking };      ///< How `read` waits for incoming bytes.
+	uint32_t m_busyPollTimeoutUs{ kdefault_busy_poll_timeout_us }; ///< Max time of spinning in the busy-poll mode if the read total timeout is 0.
+
+	/**
+	 * @brief Applies the comm timeouts matching the wait mode to the opened port.
+	 *        Blocking mode uses `m_timeouts` as is. Busy-poll mode makes ReadFile return immediately
+	 *        with whatever bytes are available, the waiting itself is done by `read`.
+	 *
+	 * @return True if timeouts were applied, False otherwise.
+	 */
+	bool applyWaitMode_();
+
+public:
+	SerialPortTransport() = default;
+	~SerialPortTransport();
+
+	SerialPortTransport(SerialPortTransport const&) = delete;
+	SerialPortTransport& operator=(SerialPortTransport const&) = delete;
+
+	/**
+	 * @brief Sets the connection parameters for the serial communication.
+	 *
+	 * Configures the serial port connection parameters according to the specifications provided
+	 * in the TM13/TM14 Thickness Monitor user manual. The function allows customization of data bits,
+	 * parity, stop bits, flow control, and baud rate, though the default values are aligned with the
+	 * device's requirements.
+	 *
+	 * @param dataBits Number of data bits per byte. The TM13/TM14 uses 8 data bits.
+	 * @param parity Type of parity to use. The TM13/TM14 requires None (0).
+	 *               Possible values are: NOPARITY (0), ODDPARITY (1), EVENPARITY (2),
+	 *               MARKPARITY (3), and SPACEPARITY (4).
+	 *
+	 * @param stopBits Number of stop bits to use. The TM13/TM14 uses 1 stop bit.
+	 *                 Possible values are: ONESTOPBIT (0), ONE5STOPBITS (1), and TWOSTOPBITS (2).
+	 *
+	 * @param flowControl Type of flow control to use. The TM13/TM14 requires None.
+	 *                    Specify as DWORD values corresponding to the desired flow control settings.
+	 *                    Common values include 0 (None), XON/XOFF, and RTS/CTS.
+	 *
+	 * @param baudRate Communication speed in bits per second (bps). For the TM13/TM14, this is fixed at 57600 bps.
+	 *                 Default value is CBR_57600. Other standard baud rates can be specified but may not be
+	 *                 applicable for the TM13/TM14.
+	 *
+	 * @note This function should be called to configure the serial port before attempting to communicate with
+	 *       the TM13/TM14 Thickness Monitor to ensure compatibility with the device's communication parameters.
+	 */
+	void setConnectionParameters(BYTE dataBits = 8, BYTE parity = NOPARITY, BYTE stopBits = ONE5STOPBITS,
+		DWORD flowControl = DTR_CONTROL_DISABLE, DWORD baudRate = CBR_57600);
+
+	/**
+	 * @brief Sets the communication timeouts for the serial port.
+	 *
+	 * This method configures the timeout parameters for reading from and writing to the serial port,
+	 * using the _COMMTIMEOUTS structure parameters. These parameters control the behavior of read and write
+	 * operations on the serial port, specifically how the system times out read or write operations.
+	 *
+	 * @param readIntervalTimeout Maximum time, in milliseconds, allowed to elapse between the arrival
+	 *                            of two consecutive characters on the communications line. Setting to MAXDWORD
+	 *                            will disable interval timeouts if both ReadTotalTimeoutMultiplier and
+	 *                            ReadTotalTimeoutConstant are also set to MAXDWORD. A value of 0 indicates
+	 *                            that interval timeouts are not used.
+	 *
+	 * @param readTotalTimeoutMultiplier Multiplier, in milliseconds, used to calculate the total time-out
+	 *                                   period for read operations. For each read operation, this value is
+	 *                                   multiplied by the requested number of bytes to be read.
+	 *
+	 * @param readTotalTimeoutConstant A constant, in milliseconds, used to calculate the total time-out
+	 *                                 period for read operations. This value is added to the product of the
+	 *                                 ReadTotalTimeoutMultiplier member and the requested number of bytes.
+	 *
+	 * @param writeTotalTimeoutMultiplier Multiplier, in milliseconds, used to calculate the total time-out
+	 *                                    period for write operations. For each write operation, this value
+	 *                                    is multiplied by the number of bytes to be written.
+	 *
+	 * @param writeTotalTimeoutConstant A constant, in milliseconds, used to calculate the total time-out
+	 *                                  period for write operations. This value is added to the product of
+	 *                                  the WriteTotalTimeoutMultiplier member and the number of bytes to be
+	 *                                  written.
+	 *
+	 * @note A time-out occurs when a read operation does not receive the expected number of bytes within
+	 *       the time-out period calculated using the multiplier and constant values. Similarly, a time-out
+	 *       occurs when a write operation cannot transmit the specified number of bytes within the calculated
+	 *       time-out period. Adjusting these parameters can help manage the flow of data over the serial port,
+	 *       especially in applications that require precise timing control.
+	 */
+	void setConnectionTimeouts(DWORD readIntervalTimeout = 50, DWORD readTotalTimeoutMultiplier = 10,
+		DWORD readTotalTimeoutConstant = 50, DWORD writeTotalTimeoutMultiplier = 10,
+		DWORD writeTotalTimeoutConstant = 50);
+
+	/**
+	 * @brief Establishes a serial connection to a specified port with a given baud rate.
+	 *
+	 * Default connection parameters from the user manual (TM13/TM14 Thickness Monitor).
+	 * 3.2 Connection parameters:
+	 *    Data bits: 8
+	 *    Parity: None
+	 *    Stop bits: 1
+	 *    Flow control: None
+	 *    Baud rate: 57600 (fixed value)
+	 *
+	 * Timeouts set before by `setConnectionTimeouts` or `setLinkTimeouts` are kept, defaults are used otherwise.
+	 *
+	 * @param portName Name of the port to connect to (e.g., "COM1", "COM2", etc.).
+	 * @param baudRate Baud rate for the connection.
+	 * @return True if connection was successfully established, False otherwise.
+	 */
+	bool establishConnection(char const* portName, DWORD baudRate = CBR_57600);
+
+	/**
+	 * @brief Changes baud rate of the opened port. Bytes pending in the driver queues are dropped,
+	 *        as they were sent or received with the previous baud rate.
+	 * @param baudRate Communication speed in bits per second (bps).
+	 * @return True if the baud rate was applied, False otherwise.
+	 */
+	bool setBaudRate(uint32_t baudRate);
+
+	/**
+	 * @brief Sets the read timeouts and applies them to the port if it is opened.
+	 *        If it isn't opened yet, `establishConnection` applies them. Write timeouts stay as set by `setConnectionTimeouts`.
+	 * @param timeouts Read timeouts, e.g. derived by the link calibration.
+	 * @return True if the timeouts were applied, False otherwise.
+	 */
+	bool setLinkTimeouts(link_timeouts_t const& timeouts);
+
+	/// @brief Returns the current read timeouts.
+	link_timeouts_t linkTimeouts() const noexcept
+	{
+		link_timeouts_t timeouts;
+		timeouts.readIntervalTimeoutMs = m_timeouts.ReadIntervalTimeout;
+		timeouts.readTotalTimeoutMultiplierMs = m_timeouts.ReadTotalTimeoutMultiplier;
+		timeouts.readTotalTimeoutConstantMs = m_timeouts.ReadTotalTimeoutConstant;
+		return timeouts;
+	}
+
+	/**
+	 * @brief Switches the read path between blocking and busy-poll waits.
+	 *
+	 * In the busy-poll wait mode the calling thread spins instead of sleeping inside the driver.
+	 * Timeouts keep the same meaning as in the blocking mode: reading ends when the buffer is full,
+	 * when no byte has arrived during the read interval timeout after the first one, or when
+	 * the read total timeout elapses. May be called before or after `establishConnection`.
+	 *
+	 * @param waitMode How `read` waits for incoming bytes.
+	 * @param busyPollTimeoutUs Max time of spinning in the busy-poll mode if the read total timeout is 0.
+	 * @return True if the wait mode was applied, False otherwise.
+	 */
+	bool setWaitMode(io_wait_mode_t waitMode, uint32_t busyPollTimeoutUs);
+
+	/**
+	 * @brief Writes data to the serial port.
+	 * @param data Pointer to the data to write.
+	 * @param size Number of bytes to write.
+	 * @return True if data was successfully written, False otherwise.
+	 */
+	bool write(uint8_t const* data, size_t size);
+
+	/**
+	 * @brief Reads data from the serial port.
+	 * @param buffer Pointer to the buffer to store read data.
+	 * @param bufferSize Size of the buffer, indicating max bytes to read.
+	 * @param bytesRead Reference to store the number of bytes actually read.
+	 * @return True if data was successfully read, False otherwise.
+	 */
+	bool read(uint8_t* buffer, size_t bufferSize, size_t& bytesRead);
+};
+#else
+#include <cstdint>
+
+#include "TtyTransport.h"
+
+static constexpr uint32_t const kdefault_serial_baud_rate{ 57600 }; ///< Fixed baud rate of the TM13/TM14.
+
+/**
+ * @brief Transport over a POSIX serial port (e.g. /dev/ttyS0, /dev/ttyUSB0).
+ *
+ * Same interface and read timeouts as the Win32 one, so `PrevacSerial` is available on both platforms.
+ * Termios has no 1.5 stop bits, the line is set to 1 stop bit of the user manual.
+ */
+class SerialPortTransport : public TtyTransport {
+public:
+	SerialPortTransport() = default;
+
+	/**
+	 * @brief Establishes a serial connection to a specified port with a given baud rate.
+	 *
+	 * Default connection parameters from the user manual (TM13/TM14 Thickness Monitor).
+	 * 3.2 Connection parameters:
+	 *    Data bits: 8
+	 *    Parity: None
+	 *    Stop bits: 1
+	 *    Flow control: None
+	 *    Baud rate: 57600 (fixed value)
+	 *
+	 * Receiver is enabled and modem control lines are ignored (CREAD | CLOCAL). Read timeouts set before
+	 * are kept.
+	 *
+	 * @param portName Path of the port to connect to (e.g. "/dev/ttyUSB0").
+	 * @param baudRate Baud rate for the connection. Must be one of the standard rates.
+	 * @return True if connection was successfully established, False otherwise.
+	 */
+	bool establishConnection(char const* portName, uint32_t baudRate = kdefault_serial_baud_rate);
+};
+#endif
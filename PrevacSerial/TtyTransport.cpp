@@ -0,0 +1,196 @@
+#ifndef _WIN32
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "TtyTransport.h"
+
+/// @brief Maps baud rate in bps to the termios speed constant, B0 if the rate isn't standard.
+static speed_t toSpeed(uint32_t baudRate)
+{
+	switch (baudRate)
+	{
+	case 9600: return B9600;
+	case 19200: return B19200;
+	case 38400: return B38400;
+	case 57600: return B57600;
+	case 115200: return B115200;
+	case 230400: return B230400;
+	default: return B0;
+	}
+}
+
+bool TtyTransport::configure_()
+{
+	termios tty{};
+	if (tcgetattr(m_fd, &tty) != 0)
+	{
+#ifdef LOG_ON
+		std::cerr << "Error: Can't get tty attributes: " << std::strerror(errno) << '\n';
+#endif
+		close_();
+		return false;
+	}
+
+	// Raw mode: no echo, no line editing, no translation of bytes.
+	cfmakeraw(&tty);
+	if (tcsetattr(m_fd, TCSANOW, &tty) != 0)
+	{
+#ifdef LOG_ON
+		std::cerr << "Error: Can't set tty attributes: " << std::strerror(errno) << '\n';
+#endif
+		close_();
+		return false;
+	}
+	return true;
+}
+
+bool TtyTransport::open_(char const* path)
+{
+	close_();
+
+	m_fd = ::open(path, O_RDWR | O_NOCTTY | O_NONBLOCK);
+	if (m_fd == -1)
+	{
+#ifdef LOG_ON
+		std::cerr << "Error: Can't open tty " << path << ": " << std::strerror(errno) << '\n';
+#endif
+		return false;
+	}
+	return true;
+}
+
+void TtyTransport::close_()
+{
+	if (m_fd != -1)
+	{
+		::close(m_fd);
+		m_fd = -1;
+	}
+}
+
+TtyTransport::~TtyTransport() { close_(); }
+
+void TtyTransport::setConnectionTimeouts(uint32_t readIntervalTimeoutMs, uint32_t readTotalTimeoutMs)
+{
+	m_readIntervalTimeoutMs = readIntervalTimeoutMs;
+	m_readTotalTimeoutMultiplierMs = 0;
+	m_readTotalTimeoutMs = readTotalTimeoutMs;
+}
+
+bool TtyTransport::setBaudRate(uint32_t baudRate)
+{
+	speed_t const speed{ toSpeed(baudRate) };
+	termios tty{};
+	if (speed == B0 || tcgetattr(m_fd, &tty) != 0 ||
+		cfsetispeed(&tty, speed) != 0 || cfsetospeed(&tty, speed) != 0 ||
+		tcsetattr(m_fd, TCSANOW, &tty) != 0)
+	{
+#ifdef LOG_ON
+		std::cerr << "Error: Can't set baud rate " << baudRate << '\n';
+#endif
+		return false;
+	}
+
+	tcflush(m_fd, TCIOFLUSH);
+	return true;
+}
+
+bool TtyTransport::setLinkTimeouts(link_timeouts_t const& timeouts)
+{
+	m_readIntervalTimeoutMs = timeouts.readIntervalTimeoutMs;
+	m_readTotalTimeoutMultiplierMs = timeouts.readTotalTimeoutMultiplierMs;
+	m_readTotalTimeoutMs = timeouts.readTotalTimeoutConstantMs;
+	return true;
+}
+
+bool TtyTransport::setWaitMode(io_wait_mode_t waitMode, uint32_t busyPollTimeoutUs)
+{
+	m_waitMode = waitMode;
+	m_busyPollTimeoutUs = busyPollTimeoutUs;
+	return true;
+}
+
+bool TtyTransport::write(uint8_t const* data, size_t size)
+{
+	size_t written{};
+	while (written < size)
+	{
+		ssize_t result{ ::write(m_fd, data + written, size - written) };
+		if (result > 0)
+			written += static_cast<size_t>(result);
+		else if (result == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+		{
+			// Output queue of the tty is full: waiting until the peer drains it.
+			pollfd pfd{ m_fd, POLLOUT, 0 };
+			if (poll(&pfd, 1, static_cast<int>(m_readTotalTimeoutMs)) <= 0)
+				return false;
+		}
+		else if (result == -1 && errno != EINTR)
+		{
+#ifdef LOG_ON
+			std::cerr << "Error: Can't write to tty: " << std::strerror(errno) << '\n';
+#endif
+			return false;
+		}
+	}
+	return true;
+}
+
+bool TtyTransport::read(uint8_t* buffer, size_t bufferSize, size_t& bytesRead)
+{
+	using clock = std::chrono::steady_clock;
+
+	bool const busyPoll{ m_waitMode == io_wait_mode_t::BusyPoll };
+	auto const totalTimeout{ std::chrono::milliseconds(m_readTotalTimeoutMultiplierMs * bufferSize + m_readTotalTimeoutMs) };
+	auto const deadline{ clock::now() + (busyPoll && totalTimeout.count() == 0 ? std::chrono::microseconds(m_busyPollTimeoutUs)
+		: std::chrono::duration_cast<std::chrono::microseconds>(totalTimeout)) };
+	auto const interval{ std::chrono::milliseconds(m_readIntervalTimeoutMs) };
+	clock::time_point lastByteTime;
+
+	// Same semantics as the serial port: stop on a full buffer, on a gap after the first byte, or on the total timeout.
+	bytesRead = 0;
+	while (bytesRead < bufferSize)
+	{
+		ssize_t result{ ::read(m_fd, buffer + bytesRead, bufferSize - bytesRead) };
+		if (result > 0)
+		{
+			bytesRead += static_cast<size_t>(result);
+			lastByteTime = clock::now();
+			continue;
+		}
+		if (result == -1 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+		{
+#ifdef LOG_ON
+			std::cerr << "Error: Can't read from tty: " << std::strerror(errno) << '\n';
+#endif
+			return false;
+		}
+
+		auto const now{ clock::now() };
+		auto const waitUntil{ bytesRead > 0 && m_readIntervalTimeoutMs != 0 ? std::min(lastByteTime + interval, deadline) : deadline };
+		if (now >= waitUntil)
+			break;
+		if (busyPoll)
+			continue;
+
+		auto const timeoutMs{ std::chrono::ceil<std::chrono::milliseconds>(waitUntil - now).count() };
+		pollfd pfd{ m_fd, POLLIN, 0 };
+		if (poll(&pfd, 1, static_cast<int>(timeoutMs)) == -1 && errno != EINTR)
+		{
+#ifdef LOG_ON
+			std::cerr << "Error: Can't wait for tty: " << std::strerror(errno) << '\n';
+#endif
+			return false;
+		}
+	}
+	return true;
+}
+#endif
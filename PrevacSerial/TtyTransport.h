@@ -0,0 +1,96 @@
+#pragma once
+#ifndef _WIN32
+#include <cstddef>
+#include <cstdint>
+
+#include "PrevacTransport.h"
+#include "RealTimeProfile.h"
+
+static constexpr uint32_t const kdefault_tty_read_interval_timeout_ms{ 50 }; ///< Same as the default read interval timeout of the Win32 serial port.
+static constexpr uint32_t const kdefault_tty_read_total_timeout_ms{ 50 };    ///< Same as the default read total timeout constant of the Win32 serial port.
+
+/**
+ * @brief Common part of the POSIX tty transports: raw non-blocking I/O on the opened descriptor.
+ *
+ * Read timeouts have the same meaning as the Win32 COMMTIMEOUTS, so the stack behaves the same on both platforms.
+ * Opening the descriptor is up to the derived transport: `PseudoTerminalTransport` or the POSIX `SerialPortTransport`.
+ */
+class TtyTransport {
+protected:
+	int m_fd{ -1 }; ///< File descriptor of the tty.
+	uint32_t m_readIntervalTimeoutMs{ kdefault_tty_read_interval_timeout_ms }; ///< Max gap between two bytes of one read.
+	uint32_t m_readTotalTimeoutMultiplierMs{};                                 ///< Per-byte part of the total read timeout.
+	uint32_t m_readTotalTimeoutMs{ kdefault_tty_read_total_timeout_ms };       ///< Constant part of the total read timeout.
+	io_wait_mode_t m_waitMode{ io_wait_mode_t::Blocking };                     ///< How `read` waits for incoming bytes.
+	uint32_t m_busyPollTimeoutUs{ kdefault_busy_poll_timeout_us };             ///< Max time of spinning in the busy-poll mode if the read total timeout is 0.
+
+	/// @brief Opens the tty in non-blocking mode without making it the controlling terminal.
+	bool open_(char const* path);
+
+	/// @brief Switches the opened tty to raw mode. Closes it on failure.
+	bool configure_();
+
+	/// @brief Closes the tty if it is opened.
+	void close_();
+
+	TtyTransport() = default;
+	~TtyTransport();
+
+public:
+	TtyTransport(TtyTransport const&) = delete;
+	TtyTransport& operator=(TtyTransport const&) = delete;
+
+	/**
+	 * @brief Sets the read timeouts, they have the same meaning as for the Win32 serial port.
+	 * @param readIntervalTimeoutMs Max gap in milliseconds between two bytes of one read. 0 disables it.
+	 * @param readTotalTimeoutMs Max wait in milliseconds of the first byte of one read.
+	 */
+	void setConnectionTimeouts(uint32_t readIntervalTimeoutMs = kdefault_tty_read_interval_timeout_ms,
+		uint32_t readTotalTimeoutMs = kdefault_tty_read_total_timeout_ms);
+
+	/**
+	 * @brief Changes baud rate of the opened tty. Pseudo-terminals accept and ignore it, real ttys apply it.
+	 *        Bytes pending in the tty queues are dropped, as they were sent or received with the previous baud rate.
+	 * @param baudRate Communication speed in bits per second (bps). Must be one of the standard rates.
+	 * @return True if the baud rate was applied, False otherwise.
+	 */
+	bool setBaudRate(uint32_t baudRate);
+
+	/**
+	 * @brief Sets the read timeouts, e.g. derived by the link calibration. May be called before the tty is opened,
+	 *        opening keeps them.
+	 * @param timeouts Read timeouts.
+	 * @return Always True.
+	 */
+	bool setLinkTimeouts(link_timeouts_t const& timeouts);
+
+	/// @brief Returns the current read timeouts.
+	link_timeouts_t linkTimeouts() const noexcept { return { m_readIntervalTimeoutMs, m_readTotalTimeoutMultiplierMs, m_readTotalTimeoutMs }; }
+
+	/**
+	 * @brief Switches the read path between blocking (poll) and busy-poll waits.
+	 *        Both modes end the read at the same total timeout.
+	 * @param waitMode How `read` waits for incoming bytes.
+	 * @param busyPollTimeoutUs Max time of spinning in the busy-poll mode if the read total timeout is 0.
+	 * @return Always True.
+	 */
+	bool setWaitMode(io_wait_mode_t waitMode, uint32_t busyPollTimeoutUs);
+
+	/**
+	 * @brief Writes data to the tty.
+	 * @param data Pointer to the data to write.
+	 * @param size Number of bytes to write.
+	 * @return True if all the data was written, False otherwise.
+	 */
+	bool write(uint8_t const* data, size_t size);
+
+	/**
+	 * @brief Reads data from the tty.
+	 * @param buffer Pointer to the buffer to store read data.
+	 * @param bufferSize Size of the buffer, indicating max bytes to read.
+	 * @param bytesRead Reference to store the number of bytes actually read.
+	 * @return True if data was successfully read or the read timed out, False on error.
+	 */
+	bool read(uint8_t* buffer, size_t bufferSize, size_t& bytesRead);
+};
+#endif
@@ -2,6 +2,25 @@
 
 #include <cerrno>
 #include <cstdint>
+#include <cstring>
+
+#ifndef _MSC_VER
+// Portability shims for non-MSVC builds (e.g. pseudo-terminal transport on Linux).
+#define __FUNCSIG__ __PRETTY_FUNCTION__
+
+using errno_t = int;
+
+/// @brief Bounds-checked memcpy with the same contract as the MSVC one.
+inline errno_t memcpy_s(void* dest, size_t destSize, void const* src, size_t count)
+{
+	if (count == 0)
+		return 0;
+	if (!dest || !src || count > destSize)
+		return EINVAL;
+	std::memcpy(dest, src, count);
+	return 0;
+}
+#endif
 
 /**
  * @brief Safely copies data from a source buffer to a destination variable and updates the offset.
@@ -3,12 +3,16 @@
 #include "PrevacSerial.h"
 #include "Utilities.h"
 
+#ifdef _WIN32
 #define COM_PORT "COM3"
+#else
+#define COM_PORT "/dev/ttyUSB0"
+#endif
 
 int main()
 {
 	PrevacSerial serial;
-	if (serial.establishConnection(COM_PORT))
+	if (serial.transport().establishConnection(COM_PORT))
 	{
 		std::cout << "Serial port " << COM_PORT << " opened successfully\n";
 
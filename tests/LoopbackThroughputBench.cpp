@@ -0,0 +1,46 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+
+#include "PrevacSerial.h"
+#include "TestUtilities.h"
+
+static constexpr size_t const kdefault_bench_frames{ 1'000'000 }; ///< Count of round trips, overridden by the first argument.
+static constexpr uint16_t const kdefault_bench_data_len{ 16 };    ///< Data length of the measured frames.
+
+/**
+ * Measures the framing stack without hardware: build, write, read and parse of every frame over the loopback.
+ * Usage: LoopbackThroughputBench [frames]
+ */
+int main(int argc, char* argv[])
+{
+	size_t const frames{ argc > 1 ? std::strtoull(argv[1], nullptr, 10) : kdefault_bench_frames };
+
+	prevac_msg_t msg;
+	msg.functionCode = 0x53;
+	msg.dataLen = kdefault_bench_data_len;
+	for (uint16_t i{}; i < msg.dataLen; ++i)
+		msg.data[i] = static_cast<uint8_t>(i);
+	msg.calculateCRC();
+
+	BasicPrevacSerial<LoopbackTransport> serial;
+	rt_profile_t profile;
+	profile.waitMode = io_wait_mode_t::BusyPoll;
+	serial.setRealTimeProfile(profile);
+
+	size_t received{};
+	prevac_msg_t reply;
+	auto const start{ std::chrono::steady_clock::now() };
+	for (size_t i{}; i < frames; ++i)
+		if (serial.sendMessage(msg) && serial.receiveMessage(reply))
+			++received;
+	double const seconds{ std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() };
+
+	CHECK(received == frames);
+
+	double const framesPerSecond{ seconds > 0.0 ? static_cast<double>(received) / seconds : 0.0 };
+	std::cout << "Loopback round trips: " << received << " frames of " << msg.size() << " bytes in " << seconds << " s, "
+		<< framesPerSecond / 1e6 << " M frames/s, " << framesPerSecond * static_cast<double>(msg.size()) / 1e6 << " MB/s\n";
+	return g_failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
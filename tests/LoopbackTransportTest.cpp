@@ -0,0 +1,108 @@
+#include <cstdint>
+
+#include "PrevacSerial.h"
+#include "TestUtilities.h"
+
+/// @brief Returns a message with `dataLen` bytes of data 0, 1, 2... and the matching CRC.
+static prevac_msg_t makeMessage(uint16_t dataLen)
+{
+	prevac_msg_t msg;
+	msg.functionCode = 0x53;
+	msg.dataLen = dataLen;
+	for (uint16_t i{}; i < dataLen && i < kdefault_max_data_len; ++i)
+		msg.data[i] = static_cast<uint8_t>(i);
+	msg.calculateCRC();
+	return msg;
+}
+
+/// @brief Checks that the message goes through the transport unchanged.
+template<PrevacTransport Transport>
+static void checkRoundTrip(BasicPrevacSerial<Transport>& sender, BasicPrevacSerial<Transport>& receiver, uint16_t dataLen)
+{
+	prevac_msg_t const sent{ makeMessage(dataLen) };
+	CHECK(sender.sendMessage(sent));
+
+	prevac_msg_t received;
+	CHECK(receiver.tryReceiveMessage(received) == receive_status_t::Ok);
+	CHECK(received.header == sent.header);
+	CHECK(received.dataLen == sent.dataLen);
+	CHECK(received.deviceAddr == sent.deviceAddr);
+	CHECK(received.deviceGroup == sent.deviceGroup);
+	CHECK(received.logicGroup == sent.logicGroup);
+	CHECK(received.driverAddr == sent.driverAddr);
+	CHECK(received.functionCode == sent.functionCode);
+	CHECK(received.crc == sent.crc);
+	for (uint16_t i{}; i < dataLen; ++i)
+		CHECK(received.data[i] == sent.data[i]);
+}
+
+static void testLoopbackRoundTrip()
+{
+	BasicPrevacSerial<LoopbackTransport> serial;
+	for (uint16_t dataLen : { 0, 1, 255 })
+		checkRoundTrip(serial, serial, dataLen);
+}
+
+static void testDataLengthOverOneByteIsRejected()
+{
+	BasicPrevacSerial<LoopbackTransport> serial;
+	prevac_msg_t const msg{ makeMessage(256) };
+	CHECK(msg.size() == 0);
+	CHECK(!serial.sendMessage(msg));
+
+	// Nothing must reach the line.
+	prevac_msg_t received;
+	CHECK(serial.tryReceiveMessage(received) == receive_status_t::Timeout);
+}
+
+static void testReceiveStatus()
+{
+	BasicPrevacSerial<LoopbackTransport> serial;
+	prevac_msg_t received;
+	CHECK(serial.tryReceiveMessage(received) == receive_status_t::Timeout);
+
+	uint8_t frame[kdefault_max_prevac_msg_size]{};
+	size_t const size{ buildPrevacFrame(frame, sizeof(frame), makeMessage(4)) };
+	CHECK(size == makeMessage(4).size());
+
+	// Corrupted data byte: the CRC doesn't match.
+	frame[8] ^= 0x10;
+	CHECK(serial.writeData(frame, size));
+	CHECK(serial.tryReceiveMessage(received) == receive_status_t::DecodeError);
+	frame[8] ^= 0x10;
+
+	// Truncated frame: the length doesn't match.
+	CHECK(serial.writeData(frame, size - 1));
+	CHECK(serial.tryReceiveMessage(received) == receive_status_t::DecodeError);
+
+	CHECK(serial.writeData(frame, size));
+	CHECK(serial.tryReceiveMessage(received) == receive_status_t::Ok);
+}
+
+#ifndef _WIN32
+static void testPseudoTerminalRoundTrip()
+{
+	BasicPrevacSerial<PseudoTerminalTransport> device;
+	CHECK(device.transport().open());
+
+	BasicPrevacSerial<PseudoTerminalTransport> host;
+	CHECK(host.transport().establishConnection(device.transport().peerName().c_str()));
+
+	for (uint16_t dataLen : { 0, 255 })
+	{
+		checkRoundTrip(host, device, dataLen);
+		checkRoundTrip(device, host, dataLen);
+	}
+}
+#endif
+
+int main()
+{
+	testLoopbackRoundTrip();
+	testDataLengthOverOneByteIsRejected();
+	testReceiveStatus();
+#ifndef _WIN32
+	testPseudoTerminalRoundTrip();
+#endif
+	return g_failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,190 @@
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include "PrevacDispatcher.h"
+#include "TestUtilities.h"
+
+/// @brief Returns a frame carrying `marker` in its data, so the handler can tell frames apart.
+static prevac_msg_t makeFrame(uint8_t marker, uint8_t deviceAddr, uint8_t functionCode = 0x53)
+{
+	prevac_msg_t msg;
+	msg.deviceAddr = deviceAddr;
+	msg.functionCode = functionCode;
+	msg.dataLen = 1;
+	msg.data[0] = marker;
+	msg.calculateCRC();
+	return msg;
+}
+
+/**
+ * @brief Handler recording markers of the handled frames. Frame with marker 0 holds the worker
+ *        until `release` is set, so the following frames pile up in the queue.
+ */
+struct recorder_t {
+	std::mutex mutex;
+	std::vector<uint8_t> markers;
+	std::atomic<bool> entered{};
+	std::atomic<bool> release{};
+
+	void operator()(prevac_msg_t const& msg)
+	{
+		if (msg.data[0] == 0)
+		{
+			entered = true;
+			while (!release)
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		std::lock_guard lock(mutex);
+		markers.emplace_back(msg.data[0]);
+	}
+
+	std::vector<uint8_t> handled()
+	{
+		std::lock_guard lock(mutex);
+		return markers;
+	}
+};
+
+/**
+ * @brief Holds the only worker with frame 0, dispatches `frames` into the queue of capacity 2, releases the worker
+ *        and waits until the queue is drained.
+ */
+static subscriber_metrics_t runBlocked(overflow_policy_t policy, std::vector<prevac_msg_t> const& frames, recorder_t& recorder)
+{
+	PrevacDispatcher dispatcher(1);
+	auto const id{ dispatcher.subscribe({}, [&recorder](prevac_msg_t const& msg) { recorder(msg); }, { 2, policy }) };
+
+	dispatcher.dispatch(makeFrame(0, 0));
+	CHECK(waitFor([&] { return recorder.entered.load(); }));
+	for (auto const& frame : frames)
+		dispatcher.dispatch(frame);
+	recorder.release = true;
+
+	CHECK(waitFor([&] { return dispatcher.metrics(id).queueDepth == 0 && recorder.handled().size() == dispatcher.metrics(id).processed; }));
+	// Processed counter is updated after the handler returns.
+	CHECK(waitFor([&] { auto const metrics{ dispatcher.metrics(id) }; return metrics.processed + metrics.dropped + metrics.coalesced == metrics.delivered; }));
+	return dispatcher.metrics(id);
+}
+
+static void testDropNewest()
+{
+	recorder_t recorder;
+	auto const metrics{ runBlocked(overflow_policy_t::DropNewest, { makeFrame(1, 1), makeFrame(2, 2), makeFrame(3, 3) }, recorder) };
+	CHECK((recorder.handled() == std::vector<uint8_t>{ 0, 1, 2 }));
+	CHECK(metrics.delivered == 4);
+	CHECK(metrics.dropped == 1);
+	CHECK(metrics.coalesced == 0);
+	CHECK(metrics.maxQueueDepth == 2);
+	CHECK(metrics.maxLagUs > 0.0);
+}
+
+static void testDropOldest()
+{
+	recorder_t recorder;
+	auto const metrics{ runBlocked(overflow_policy_t::DropOldest, { makeFrame(1, 1), makeFrame(2, 2), makeFrame(3, 3) }, recorder) };
+	CHECK((recorder.handled() == std::vector<uint8_t>{ 0, 2, 3 }));
+	CHECK(metrics.delivered == 4);
+	CHECK(metrics.dropped == 1);
+	CHECK(metrics.coalesced == 0);
+	CHECK(metrics.maxQueueDepth == 2);
+}
+
+static void testCoalesceLatest()
+{
+	// Frame 2 replaces frame 1 of the same device in place; frame 4 of a new device evicts the oldest one.
+	recorder_t recorder;
+	auto const metrics{ runBlocked(overflow_policy_t::CoalesceLatest,
+		{ makeFrame(1, 1), makeFrame(2, 1), makeFrame(3, 2), makeFrame(4, 3) }, recorder) };
+	CHECK((recorder.handled() == std::vector<uint8_t>{ 0, 3, 4 }));
+	CHECK(metrics.delivered == 5);
+	CHECK(metrics.coalesced == 1);
+	CHECK(metrics.dropped == 1);
+}
+
+static void testFilter()
+{
+	PrevacDispatcher dispatcher(1);
+	std::atomic<int> handled{};
+	subscription_filter_t filter;
+	filter.deviceAddr = 1;
+	filter.functionCode = 0x54;
+	auto const id{ dispatcher.subscribe(filter, [&](prevac_msg_t const&) { ++handled; }) };
+
+	dispatcher.dispatch(makeFrame(1, 1, 0x53));
+	dispatcher.dispatch(makeFrame(2, 2, 0x54));
+	dispatcher.dispatch(makeFrame(3, 1, 0x54));
+	CHECK(waitFor([&] { return dispatcher.metrics(id).processed == 1; }));
+	CHECK(dispatcher.metrics(id).delivered == 1);
+	CHECK(handled == 1);
+}
+
+static void testHandlerThrows()
+{
+	PrevacDispatcher dispatcher(1);
+	std::atomic<int> handled{};
+	auto const id{ dispatcher.subscribe({}, [&](prevac_msg_t const& msg)
+		{
+			if (msg.data[0] == 1)
+				throw std::runtime_error("handler failed");
+			if (msg.data[0] == 2)
+				throw 2;
+			++handled;
+		}) };
+
+	// The worker survives both exceptions and handles the next frame.
+	dispatcher.dispatch(makeFrame(1, 1));
+	dispatcher.dispatch(makeFrame(2, 1));
+	dispatcher.dispatch(makeFrame(3, 1));
+	CHECK(waitFor([&] { return dispatcher.metrics(id).processed == 3; }));
+	CHECK(dispatcher.metrics(id).failed == 2);
+	CHECK(handled == 1);
+}
+
+/// @brief Transport whose reads always fail, like a disconnected port.
+struct failing_transport_t {
+	bool write(uint8_t const*, size_t) { return true; }
+	bool read(uint8_t*, size_t, size_t& bytesRead)
+	{
+		bytesRead = 0;
+		return false;
+	}
+};
+
+static void testReceiveAndDispatch()
+{
+	PrevacDispatcher dispatcher(1);
+	std::atomic<int> handled{};
+	auto const id{ dispatcher.subscribe({}, [&](prevac_msg_t const&) { ++handled; }) };
+
+	BasicPrevacSerial<LoopbackTransport> serial;
+	CHECK(serial.sendMessage(makeFrame(1, 1)));
+	uint8_t const junk[]{ 0x00, 0x01, 0x02 };
+	CHECK(serial.writeData(junk, sizeof(junk)));
+	CHECK(serial.sendMessage(makeFrame(2, 1)));
+
+	receive_stats_t stats;
+	{
+		std::jthread receiver([&](std::stop_token stopToken) { CHECK(receiveAndDispatch(serial, dispatcher, stopToken, &stats)); });
+		CHECK(waitFor([&] { return stats.frames == 2 && stats.timeouts > 0; }));
+	}
+	CHECK(stats.decodeErrors == 1);
+	CHECK(waitFor([&] { return dispatcher.metrics(id).processed == 2; }));
+	CHECK(handled == 2);
+
+	// Transport error ends the loop instead of spinning on it.
+	BasicPrevacSerial<failing_transport_t> broken;
+	CHECK(!receiveAndDispatch(broken, dispatcher, std::stop_token{}));
+}
+
+int main()
+{
+	testDropNewest();
+	testDropOldest();
+	testCoalesceLatest();
+	testFilter();
+	testHandlerThrows();
+	testReceiveAndDispatch();
+	return g_failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+/// @brief Count of failed checks of the test executable, returned from `main`.
+inline int g_failures{};
+
+/// @brief Checks the condition, prints the failed expression with its location and goes on.
+#define CHECK(condition)                                                                        \
+	do                                                                                          \
+	{                                                                                           \
+		if (!(condition))                                                                       \
+		{                                                                                       \
+			std::cerr << __FILE__ << ':' << __LINE__ << ": check failed: " #condition << '\n'; \
+			++g_failures;                                                                       \
+		}                                                                                       \
+	} while (false)
+
+/**
+ * @brief Waits until the predicate holds, polling it every millisecond.
+ * @return True if the predicate held before the timeout, False otherwise.
+ */
+template<typename Predicate>
+bool waitFor(Predicate predicate, std::chrono::milliseconds timeout = std::chrono::milliseconds(2000))
+{
+	auto const deadline{ std::chrono::steady_clock::now() + timeout };
+	while (!predicate())
+	{
+		if (std::chrono::steady_clock::now() >= deadline)
+			return false;
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	return true;
+}